@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+#include "memory_stats.cpp"
+
+// Reemplaza el operator new/delete global para contar bytes vivos y
+// asignaciones por categoría (MemTag). Se incluye solo en el ejecutable que
+// quiere medir (mainmemoria); el resto no paga nada.
+//
+// Cada bloque lleva una cabecera de 16 bytes con su categoría y tamaño, así
+// delete descuenta de la misma categoría aunque el ámbito ya sea otro. Los
+// bytes que se cuentan son los que malloc realmente reservó para el pedido
+// (malloc_usable_size, con su redondeo) más su cabecera de 8 bytes, sin la
+// cabecera propia de este contador.
+
+struct AllocCounters {
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> live_count{0};
+    std::atomic<uint64_t> total_count{0};   // asignaciones desde el inicio
+};
+
+struct AllocSnapshot {
+    std::array<int64_t, static_cast<size_t>(MemTag::COUNT)> live_bytes{};
+    std::array<int64_t, static_cast<size_t>(MemTag::COUNT)> live_count{};
+    std::array<uint64_t, static_cast<size_t>(MemTag::COUNT)> total_count{};
+
+    int64_t bytes(MemTag t) const { return live_bytes[static_cast<size_t>(t)]; }
+    int64_t total_bytes() const {
+        int64_t s = 0;
+        for (int64_t b : live_bytes) s += b;
+        return s;
+    }
+    uint64_t allocations() const {
+        uint64_t s = 0;
+        for (uint64_t c : total_count) s += c;
+        return s;
+    }
+};
+
+namespace alloc_tracking {
+
+const size_t MALLOC_OVERHEAD = sizeof(size_t);   // cabecera de glibc por bloque
+
+struct Header {
+    uint32_t offset;                    // del inicio del bloque de malloc al usuario
+    uint8_t tag;
+    uint8_t pad[3];
+    uint64_t bytes;                     // lo contado al asignar
+};
+static_assert(sizeof(Header) == 16, "la cabecera mantiene la alineación de malloc");
+
+inline std::array<AllocCounters, static_cast<size_t>(MemTag::COUNT)>& counters() {
+    static std::array<AllocCounters, static_cast<size_t>(MemTag::COUNT)> c;
+    return c;
+}
+
+inline void* allocate(size_t n, size_t align) {
+    size_t pad = std::max(sizeof(Header), align);
+    void* raw = (align > alignof(std::max_align_t)) ? std::aligned_alloc(align, (n + pad + align - 1) / align * align)
+                                                    : std::malloc(n + pad);
+    if (!raw) throw std::bad_alloc();
+    char* user = static_cast<char*>(raw) + pad;
+    Header* h = reinterpret_cast<Header*>(user) - 1;
+    h->offset = static_cast<uint32_t>(pad);
+    h->tag = static_cast<uint8_t>(current_mem_tag);
+    h->bytes = malloc_usable_size(raw) - pad + MALLOC_OVERHEAD;
+
+    AllocCounters& c = counters()[h->tag];
+    c.live_bytes.fetch_add(static_cast<int64_t>(h->bytes), std::memory_order_relaxed);
+    c.live_count.fetch_add(1, std::memory_order_relaxed);
+    c.total_count.fetch_add(1, std::memory_order_relaxed);
+    return user;
+}
+
+inline void release(void* p) {
+    if (!p) return;
+    Header* h = static_cast<Header*>(p) - 1;
+    AllocCounters& c = counters()[h->tag];
+    c.live_bytes.fetch_sub(static_cast<int64_t>(h->bytes), std::memory_order_relaxed);
+    c.live_count.fetch_sub(1, std::memory_order_relaxed);
+    std::free(static_cast<char*>(p) - h->offset);
+}
+
+}  // namespace alloc_tracking
+
+inline AllocSnapshot alloc_snapshot() {
+    AllocSnapshot s;
+    for (size_t t = 0; t < static_cast<size_t>(MemTag::COUNT); ++t) {
+        const AllocCounters& c = alloc_tracking::counters()[t];
+        s.live_bytes[t] = c.live_bytes.load(std::memory_order_relaxed);
+        s.live_count[t] = c.live_count.load(std::memory_order_relaxed);
+        s.total_count[t] = c.total_count.load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+void* operator new(size_t n) { return alloc_tracking::allocate(n, alignof(std::max_align_t)); }
+void* operator new[](size_t n) { return alloc_tracking::allocate(n, alignof(std::max_align_t)); }
+void* operator new(size_t n, std::align_val_t a) { return alloc_tracking::allocate(n, static_cast<size_t>(a)); }
+void* operator new[](size_t n, std::align_val_t a) { return alloc_tracking::allocate(n, static_cast<size_t>(a)); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    try { return alloc_tracking::allocate(n, alignof(std::max_align_t)); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t n, const std::nothrow_t&) noexcept {
+    try { return alloc_tracking::allocate(n, alignof(std::max_align_t)); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { alloc_tracking::release(p); }
+void operator delete[](void* p) noexcept { alloc_tracking::release(p); }
+void operator delete(void* p, size_t) noexcept { alloc_tracking::release(p); }
+void operator delete[](void* p, size_t) noexcept { alloc_tracking::release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alloc_tracking::release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alloc_tracking::release(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { alloc_tracking::release(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { alloc_tracking::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { alloc_tracking::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { alloc_tracking::release(p); }
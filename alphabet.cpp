@@ -0,0 +1,99 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Alfabetos del trie (política de BasicTrie). Cada uno fija las letras que
+// existen y en qué hijo cae cada una con una tabla constexpr byte -> índice:
+// bajar una letra es una lectura de la tabla, sin tolower ni comparaciones.
+// El índice END (el último) es el '$' que marca fin de palabra.
+//
+// Al trie las palabras llegan normalizadas, un byte por letra. Decodificar
+// UTF-8 es trabajo de Tokenizer (tokenizer.cpp): con un alfabeto UTF8 pasa
+// las letras Latin-1 (U+00C0..U+00FF) por fold_latin1 al cargar el texto.
+
+// Tabla byte -> índice a partir de las letras normalizadas: también acepta
+// la mayúscula ASCII (y la Latin-1) de cada letra, y '$' queda en el último
+template <size_t N>
+constexpr std::array<int8_t, 256> make_alphabet_index(const std::array<unsigned char, N>& symbols) {
+    std::array<int8_t, 256> index{};
+    for (int8_t& k : index) k = -1;
+    for (size_t k = 0; k < N; ++k) {
+        unsigned char c = symbols[k];
+        index[c] = static_cast<int8_t>(k);
+        if ((c >= 'a' && c <= 'z') || c >= 0xE0) index[c - 0x20] = static_cast<int8_t>(k);
+    }
+    index['$'] = static_cast<int8_t>(N);
+    return index;
+}
+
+// Hijo de un byte en el alfabeto dado, -1 si no es letra ni '$'
+template <class Alphabet>
+inline int alphabet_index(char c) {
+    return Alphabet::INDEX[static_cast<unsigned char>(c)];
+}
+
+// Las 26 letras de siempre; el resto de los bytes se descarta
+struct AsciiAlphabet {
+    static constexpr const char* NAME = "ascii";
+    static constexpr bool UTF8 = false;
+    static constexpr int LETTERS = 26;
+    static constexpr int END = LETTERS;
+    static constexpr int SIZE = LETTERS + 1;
+
+    static constexpr std::array<unsigned char, LETTERS> SYMBOLS = {
+        'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+        'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z'};
+    static constexpr std::array<int8_t, 256> INDEX = make_alphabet_index(SYMBOLS);
+
+    static constexpr unsigned char fold_latin1(unsigned char) { return 0; }
+    static std::string to_utf8(std::string_view w) { return std::string(w); }
+};
+
+// Español: las 26 letras más ñ, á, é, í, ó, ú y ü, guardadas como su byte
+// Latin-1 en minúscula. Las demás letras Latin-1 con diacrítico se pliegan a
+// su letra base (ç -> c, à -> a) para no separar palabras por una tilde ajena
+struct SpanishAlphabet {
+    static constexpr const char* NAME = "español";
+    static constexpr bool UTF8 = true;
+    static constexpr int LETTERS = 33;
+    static constexpr int END = LETTERS;
+    static constexpr int SIZE = LETTERS + 1;
+
+    static constexpr std::array<unsigned char, LETTERS> SYMBOLS = {
+        'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+        'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+        0xF1, 0xE1, 0xE9, 0xED, 0xF3, 0xFA, 0xFC};   // ñ á é í ó ú ü
+    static constexpr std::array<int8_t, 256> INDEX = make_alphabet_index(SYMBOLS);
+
+    // Código Latin-1 (0xC0..0xFF) -> byte normalizado, 0 si no es letra
+    static constexpr unsigned char fold_latin1(unsigned char cp) {
+        // Minúsculas 0xE0..0xFF: las del alfabeto quedan, el resto a su base
+        constexpr unsigned char FOLD[32] = {
+            'a', 0xE1, 'a', 'a', 'a', 'a', 'a', 'c',    // à á â ã ä å æ ç
+            'e', 0xE9, 'e', 'e', 'i', 0xED, 'i', 'i',   // è é ê ë ì í î ï
+            'd', 0xF1, 'o', 0xF3, 'o', 'o', 'o', 0,     // ð ñ ò ó ô õ ö ÷
+            'o', 'u', 0xFA, 'u', 0xFC, 'y', 't', 'y'};  // ø ù ú û ü ý þ ÿ
+        if (cp == 0xDF) return 's';                     // ß
+        if (cp < 0xE0) cp += 0x20;                      // mayúsculas (× queda como ÷)
+        return FOLD[cp - 0xE0];
+    }
+
+    // Para mostrar una palabra guardada: Latin-1 -> UTF-8
+    static std::string to_utf8(std::string_view w) {
+        std::string s;
+        s.reserve(w.size() + 4);
+        for (char c : w) {
+            unsigned char u = static_cast<unsigned char>(c);
+            if (u < 0x80) {
+                s.push_back(c);
+            } else {
+                s.push_back(static_cast<char>(0xC0 | (u >> 6)));
+                s.push_back(static_cast<char>(0x80 | (u & 0x3F)));
+            }
+        }
+        return s;
+    }
+};
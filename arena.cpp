@@ -0,0 +1,496 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "epoch.cpp"
+#include "memory_stats.cpp"
+
+// Arena por bloques (chunks) direccionada con índices de 32 bits.
+// Los elementos nunca se mueven: crecer agrega un chunk nuevo, y liberar
+// todo es soltar los chunks de una vez (sin recorrer el árbol).
+// Sus asignaciones (chunks y directorio) se atribuyen a tag_.
+
+template <class T, uint32_t CHUNK_BITS = 12>
+struct ChunkArena {
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const uint32_t CHUNK_MASK = CHUNK_SIZE - 1;
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    MemTag tag_ = MemTag::OTHER;
+    std::vector<std::unique_ptr<T[]>> chunks_;  // dueño de los chunks
+    uint32_t size_ = 0;  // próxima posición libre (bump)
+    size_t chunk_count_ = 0;  // chunks en el directorio (propios o de attach)
+
+    // Directorio de chunks que usa operator[]. Crece duplicándose y los
+    // directorios viejos se guardan hasta clear(), así un lector concurrente
+    // que todavía tenga uno sigue leyendo memoria válida.
+    std::vector<std::unique_ptr<T*[]>> dirs_;
+    T** dir_ = nullptr;
+    size_t dir_capacity_ = 0;
+
+    explicit ChunkArena(MemTag tag = MemTag::OTHER) : tag_(tag) {}
+
+    T& operator[](uint32_t i) { return dir_[i >> CHUNK_BITS][i & CHUNK_MASK]; }
+    const T& operator[](uint32_t i) const { return dir_[i >> CHUNK_BITS][i & CHUNK_MASK]; }
+
+    // operator[] para un lector concurrente con el hilo que hace alloc()
+    const T& shared(uint32_t i) const {
+        return load_shared(dir_, std::memory_order_acquire)[i >> CHUNK_BITS][i & CHUNK_MASK];
+    }
+
+    void add_chunk(std::unique_ptr<T[]> c) {
+        MemTagScope scope(tag_);
+        push_chunk(c.get());
+        chunks_.push_back(std::move(c));
+    }
+
+    void push_chunk(T* c) {
+        MemTagScope scope(tag_);
+        size_t n = chunk_count_;
+        if (n == dir_capacity_) {
+            size_t cap = std::max<size_t>(16, 2 * dir_capacity_);
+            std::unique_ptr<T*[]> dir(new T*[cap]);
+            std::copy(dir_, dir_ + n, dir.get());
+            store_shared(dir_, dir.get(), std::memory_order_release);
+            dirs_.push_back(std::move(dir));
+            dir_capacity_ = cap;
+        }
+        dir_[n] = c;
+        chunk_count_ = n + 1;
+    }
+
+    // Usa memoria ajena (p.ej. un mmap) como los primeros `chunks` chunks,
+    // contiguos a partir de data. No queda en chunks_, así que clear() no la
+    // libera; alloc() sigue agregando chunks propios después de ellos.
+    void attach(T* data, size_t chunks, uint32_t size) {
+        clear();
+        for (size_t c = 0; c < chunks; ++c) push_chunk(data + c * CHUNK_SIZE);
+        size_ = size;
+    }
+
+    // Chunk c del directorio (CHUNK_SIZE elementos)
+    const T* chunk(size_t c) const { return dir_[c]; }
+    size_t chunk_count() const { return chunk_count_; }
+
+    // Reserva n elementos contiguos dentro de un mismo chunk y retorna el
+    // índice del primero. Si no caben en el chunk actual se salta al siguiente.
+    uint32_t alloc(uint32_t n = 1) {
+        uint32_t offset = size_ & CHUNK_MASK;
+        if (size_ > 0 && offset + n > CHUNK_SIZE) {
+            size_ += CHUNK_SIZE - offset;
+        }
+        while ((size_ + n - 1) >> CHUNK_BITS >= chunk_count_) {
+            MemTagScope scope(tag_);
+            add_chunk(std::unique_ptr<T[]>(new T[CHUNK_SIZE]()));
+        }
+        uint32_t i = size_;
+        size_ += n;
+        return i;
+    }
+
+    // Agrega n elementos al final, seguidos aunque crucen un borde de chunk
+    // (para copiar un rango de otra arena sin huecos); retorna el primero
+    uint32_t extend(uint32_t n) {
+        size_t chunks = (static_cast<size_t>(size_) + n + CHUNK_MASK) >> CHUNK_BITS;
+        while (chunk_count_ < chunks) {
+            MemTagScope scope(tag_);
+            add_chunk(std::unique_ptr<T[]>(new T[CHUNK_SIZE]()));
+        }
+        uint32_t i = size_;
+        size_ += n;
+        return i;
+    }
+
+    // Libera todos los chunks
+    void clear() {
+        chunks_.clear();
+        dirs_.clear();
+        dir_ = nullptr;
+        dir_capacity_ = 0;
+        chunk_count_ = 0;
+        size_ = 0;
+    }
+
+    // Pasa al final los chunks de otra arena (que queda vacía) y retorna lo
+    // que hay que sumar a sus índices. Se salta al borde de chunk para que
+    // los índices de la otra arena se conserven con solo sumar la base.
+    uint32_t adopt(ChunkArena& other) {
+        uint32_t base = static_cast<uint32_t>(chunk_count_) << CHUNK_BITS;
+        if (other.size_ == 0) return base;
+        assert(other.chunks_.size() == other.chunk_count_);
+        for (auto& c : other.chunks_) add_chunk(std::move(c));
+        size_ = base + other.size_;
+        other.clear();
+        return base;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity_bytes() const { return chunk_count_ * CHUNK_SIZE * sizeof(T); }
+};
+
+// Tipos de bloque de hijos, comunes a todos los tamaños de alfabeto
+struct ChildBlockKinds {
+    enum Kind : uint8_t { N0 = 0, N1, N4, N16, NFULL, NUM_KINDS };
+};
+
+// Bloques de hijos adaptativos (estilo ART) compartidos por Trie y RadixTrie.
+// La capacidad del bloque crece 0 -> 1 -> 4 -> 16 -> FULL (27 con el
+// alfabeto ASCII: 26 letras y '$') a medida que se agregan hijos. En
+// N1/N4/N16 el bloque guarda [hijos | claves] y se busca linealmente, en
+// NFULL el bloque se indexa directo por letra.
+// El nodo solo guarda (kids, kind, count); todo lo demás vive aquí.
+//
+// Lectores concurrentes (child_shared) con un único escritor: agregar un
+// hijo escribe slot y clave antes de publicar count (release), y grow()
+// cambia el par (kids, kind) dentro de un seqlock para que el lector nunca
+// combine el tipo nuevo con el bloque viejo. Si hay EpochManager, el bloque
+// viejo vuelve a la lista libre recién cuando ningún lector puede tenerlo.
+template <int FULL>
+struct BasicChildBlocks : ChildBlockKinds {
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    ChunkArena<uint32_t, 14> slots_{MemTag::CHILDREN};
+    std::array<std::vector<uint32_t>, NUM_KINDS> free_blocks_;  // bloques liberados al crecer
+    std::array<size_t, NUM_KINDS> kind_count_{};                // histograma de tipos de nodo
+    size_t bytes_ = 0;                                          // bytes en bloques vivos
+
+    EpochManager* epoch_ = nullptr;       // lectores concurrentes (ver arriba)
+    std::atomic<uint32_t> grow_seq_{0};   // impar mientras grow() cambia (kids, kind)
+
+    BasicChildBlocks() = default;
+    ~BasicChildBlocks() { if (epoch_) epoch_->drain(); }
+
+    static int capacity(uint8_t kind) {
+        static const int caps[NUM_KINDS] = {0, 1, 4, 16, FULL};
+        return caps[kind];
+    }
+
+    // Slots de 32 bits que ocupa un bloque: hijos + claves empaquetadas de a 4
+    static uint32_t block_words(uint8_t kind) {
+        static const uint32_t words[NUM_KINDS] = {0, 2, 5, 20, FULL};
+        return words[kind];
+    }
+
+    void clear() {
+        if (epoch_) epoch_->drain();
+        slots_.clear();
+        for (auto& fl : free_blocks_) fl.clear();
+        kind_count_.fill(0);
+        bytes_ = 0;
+    }
+
+    // Todo nodo nuevo nace como hoja (N0) y se libera como hoja
+    void note_new_node() { ++kind_count_[N0]; }
+    void note_free_node() { --kind_count_[N0]; }
+
+    // Claves de N1/N4/N16, guardadas justo después de los hijos
+    template <class N> uint8_t* keys(const N* u) {
+        return reinterpret_cast<uint8_t*>(&slots_[u->kids + capacity(u->kind)]);
+    }
+    template <class N> const uint8_t* keys(const N* u) const {
+        return reinterpret_cast<const uint8_t*>(&slots_[u->kids + capacity(u->kind)]);
+    }
+
+    template <class N> uint32_t child(const N* u, int idx) const {
+        if (u->kind == NFULL) return slots_[u->kids + idx];
+        if (u->kind == N0) return NONE;
+        const uint32_t* kids = &slots_[u->kids];
+        const uint8_t* k = keys(u);
+        for (int i = 0; i < u->count; ++i)
+            if (k[i] == idx) return kids[i];
+        return NONE;
+    }
+
+    // Pide a la caché lo que child(u, idx) va a leer, para las búsquedas
+    // por lotes: el slot exacto en NFULL, o los hijos y sus claves en el resto
+    template <class N> void prefetch(const N* u, int idx) const {
+        if (u->kind == N0) return;
+        if (u->kind == NFULL) {
+            __builtin_prefetch(&slots_[u->kids + idx]);
+            return;
+        }
+        __builtin_prefetch(&slots_[u->kids]);
+        __builtin_prefetch(keys(u));
+    }
+
+    // child() para un lector concurrente con un único escritor
+    template <class N> uint32_t child_shared(const N* u, int idx) const {
+        uint8_t kind, count;
+        uint32_t kids;
+        while (true) {
+            uint32_t seq = grow_seq_.load(std::memory_order_acquire);
+            kind = load_shared(u->kind);
+            kids = load_shared(u->kids);
+            count = load_shared(u->count, std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!(seq & 1) && grow_seq_.load(std::memory_order_relaxed) == seq) break;
+        }
+        if (kind == NFULL) return load_shared(slots_.shared(kids + idx), std::memory_order_acquire);
+        if (kind == N0) return NONE;
+        const uint32_t* block = &slots_.shared(kids);
+        const uint8_t* k = reinterpret_cast<const uint8_t*>(block + capacity(kind));
+        for (int i = 0; i < count; ++i)
+            if (load_shared(k[i]) == idx) return load_shared(block[i]);
+        return NONE;
+    }
+
+    // Agrega el hijo c con clave idx (no debe existir), creciendo si hace falta
+    template <class N> void add_child(N* u, int idx, uint32_t c) {
+        if (u->kind != NFULL && u->count == capacity(u->kind)) grow(u);
+        if (u->kind == NFULL) {
+            store_shared(slots_[u->kids + idx], c, std::memory_order_release);
+        } else {
+            store_shared(slots_[u->kids + u->count], c);
+            store_shared(keys(u)[u->count], static_cast<uint8_t>(idx));
+        }
+        store_shared(u->count, static_cast<uint8_t>(u->count + 1), std::memory_order_release);
+    }
+
+    // Reemplaza el hijo existente con clave idx
+    template <class N> void set_child(N* u, int idx, uint32_t c) {
+        if (u->kind == NFULL) {
+            store_shared(slots_[u->kids + idx], c, std::memory_order_release);
+            return;
+        }
+        const uint8_t* k = keys(u);
+        for (int i = 0; i < u->count; ++i)
+            if (k[i] == idx) store_shared(slots_[u->kids + i], c, std::memory_order_release);
+    }
+
+    // f(idx, c) para cada hijo c de u
+    template <class N, class F> void for_each_child(const N* u, F&& f) const {
+        if (u->kind == N0) return;
+        const uint32_t* kids = &slots_[u->kids];
+        if (u->kind == NFULL) {
+            for (int i = 0; i < FULL; ++i)
+                if (kids[i] != NONE) f(i, kids[i]);
+            return;
+        }
+        const uint8_t* k = keys(u);
+        for (int i = 0; i < u->count; ++i) f(k[i], kids[i]);
+    }
+
+    // Quita el hijo c de u (sin lectores concurrentes). El bloque baja al
+    // tipo anterior cuando queda a menos de la mitad de éste, así borrar e
+    // insertar alrededor del borde no copia el bloque cada vez; sin hijos
+    // u vuelve a ser hoja
+    template <class N> void remove_child(N* u, uint32_t c) {
+        assert(!epoch_);
+        uint32_t* kids = &slots_[u->kids];
+        if (u->kind == NFULL) {
+            for (int i = 0; i < FULL; ++i)
+                if (kids[i] == c) kids[i] = NONE;
+        } else {
+            uint8_t* k = keys(u);
+            int last = u->count - 1;
+            for (int i = 0; i <= last; ++i) {
+                if (kids[i] != c) continue;
+                kids[i] = kids[last];
+                k[i] = k[last];
+                break;
+            }
+        }
+        --u->count;
+        if (u->count == 0) {
+            discard(u);
+        } else if (u->kind > N1 && u->count <= capacity(u->kind - 1) / 2) {
+            shrink(u);
+        }
+    }
+
+    uint32_t alloc_block(uint8_t kind) {
+        std::vector<uint32_t>& fl = free_blocks_[kind];
+        if (!fl.empty()) {
+            uint32_t b = fl.back();
+            fl.pop_back();
+            return b;
+        }
+        return slots_.alloc(block_words(kind));
+    }
+
+    // Cambia el bloque de hijos de u al tipo siguiente, copiando los hijos
+    template <class N> void grow(N* u) {
+        uint8_t to = u->kind + 1;
+        uint32_t b = alloc_block(to);
+        uint32_t* kids = &slots_[b];
+        if (to == NFULL) {
+            std::fill(kids, kids + FULL, static_cast<uint32_t>(NONE));
+            const uint8_t* k = keys(u);
+            for (int i = 0; i < u->count; ++i) kids[k[i]] = slots_[u->kids + i];
+        } else if (u->count > 0) {
+            std::copy(&slots_[u->kids], &slots_[u->kids] + u->count, kids);
+            std::copy(keys(u), keys(u) + u->count,
+                      reinterpret_cast<uint8_t*>(kids + capacity(to)));
+        }
+        if (u->kind != N0) release_block(u->kind, u->kids);
+        bytes_ += (block_words(to) - block_words(u->kind)) * sizeof(uint32_t);
+        --kind_count_[u->kind];
+        ++kind_count_[to];
+
+        uint32_t seq = grow_seq_.load(std::memory_order_relaxed);
+        grow_seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        store_shared(u->kids, b);
+        store_shared(u->kind, to);
+        grow_seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Lo inverso de grow(): pasa u al tipo anterior (sus hijos caben)
+    template <class N> void shrink(N* u) {
+        uint8_t to = u->kind - 1;
+        uint32_t b = alloc_block(to);
+        uint32_t* kids = &slots_[b];
+        uint8_t* k = reinterpret_cast<uint8_t*>(kids + capacity(to));
+        int n = 0;
+        for_each_child(u, [&](int idx, uint32_t c) {
+            kids[n] = c;
+            k[n++] = static_cast<uint8_t>(idx);
+        });
+        release_block(u->kind, u->kids);
+        bytes_ -= (block_words(u->kind) - block_words(to)) * sizeof(uint32_t);
+        --kind_count_[u->kind];
+        ++kind_count_[to];
+        u->kids = b;
+        u->kind = to;
+    }
+
+    // Devuelve un bloque a la lista libre; con lectores, tras un período de gracia
+    void release_block(uint8_t kind, uint32_t b) {
+        if (epoch_) {
+            epoch_->retire([this, kind, b] { free_blocks_[kind].push_back(b); });
+        } else {
+            MemTagScope scope(MemTag::CHILDREN);
+            free_blocks_[kind].push_back(b);
+        }
+    }
+
+    // Suelta el bloque de u (queda en la lista libre) y lo deja como hoja
+    template <class N> void discard(N* u) {
+        if (u->kind != N0) release_block(u->kind, u->kids);
+        bytes_ -= block_words(u->kind) * sizeof(uint32_t);
+        --kind_count_[u->kind];
+        ++kind_count_[N0];
+        u->kids = NONE;
+        u->kind = N0;
+        u->count = 0;
+    }
+
+    // Toma los bloques de otro ChildBlocks; retorna la base para sus índices
+    uint32_t adopt(BasicChildBlocks& other) {
+        uint32_t base = slots_.adopt(other.slots_);
+        for (int k = 0; k < NUM_KINDS; ++k) {
+            for (uint32_t b : other.free_blocks_[k]) free_blocks_[k].push_back(b + base);
+            kind_count_[k] += other.kind_count_[k];
+        }
+        bytes_ += other.bytes_;
+        other.clear();
+        return base;
+    }
+
+    // Suma node_base a los hijos de u (tras mover sus nodos de arena)
+    template <class N> void rebase_children(N* u, uint32_t node_base) {
+        if (u->kind == N0) return;
+        uint32_t* kids = &slots_[u->kids];
+        int n = (u->kind == NFULL) ? FULL : u->count;
+        for (int i = 0; i < n; ++i)
+            if (kids[i] != NONE) kids[i] += node_base;
+    }
+
+    size_t capacity_bytes() const { return slots_.capacity_bytes(); }
+};
+
+typedef BasicChildBlocks<27> ChildBlocks;
+
+// Palabras de los terminales, compartidas por Trie, RadixTrie y
+// DoubleArrayTrie. Las letras van una tras otra en un pool append-only y
+// cada palabra es (offset, largo) de 32 bits, entregada como string_view:
+// 8 bytes por palabra más sus letras, sin un std::string ni un bloque de
+// heap por palabra. Una palabra nunca cruza un chunk y los chunks no se
+// mueven, así que las string_view siguen válidas al agregar más.
+//
+// release() (para el presupuesto de memoria del trie) deja libre el índice
+// para la próxima palabra; sus letras quedan muertas en el pool hasta que
+// compact_if_sparse() lo rearma, y eso sí invalida las string_view.
+struct WordPool {
+    static const uint32_t CHAR_BITS = 16;
+    static const uint32_t MAX_LENGTH = 1u << CHAR_BITS;   // letras por palabra
+
+    struct Ref {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    ChunkArena<char, CHAR_BITS> chars_{MemTag::WORDS};
+    ChunkArena<Ref> refs_{MemTag::WORDS};
+    size_t bytes_ = 0;                    // letras guardadas
+    size_t dead_bytes_ = 0;               // letras de palabras liberadas
+    std::vector<uint32_t> free_ids_;      // índices liberados, se reusan
+
+    // Agrega w (a lo más MAX_LENGTH letras) y retorna su índice
+    uint32_t append(std::string_view w) {
+        assert(w.size() <= MAX_LENGTH);
+        uint32_t length = static_cast<uint32_t>(w.size());
+        uint32_t offset = length ? chars_.alloc(length) : static_cast<uint32_t>(chars_.size());
+        if (length) std::copy(w.begin(), w.end(), &chars_[offset]);
+        bytes_ += length;
+        uint32_t id;
+        if (!free_ids_.empty()) {
+            id = free_ids_.back();
+            free_ids_.pop_back();
+        } else {
+            id = refs_.alloc();
+        }
+        refs_[id] = Ref{offset, length};
+        return id;
+    }
+
+    void release(uint32_t w) {
+        bytes_ -= refs_[w].length;
+        dead_bytes_ += refs_[w].length;
+        refs_[w] = Ref{0, 0};
+        MemTagScope scope(MemTag::WORDS);
+        free_ids_.push_back(w);
+    }
+
+    // Copia las letras vivas a un pool nuevo cuando las muertas ya son más
+    // que las vivas (y al menos un chunk): el costo se amortiza en las
+    // liberaciones que lo dispararon
+    void compact_if_sparse() {
+        if (dead_bytes_ <= bytes_ || dead_bytes_ < ChunkArena<char, CHAR_BITS>::CHUNK_SIZE) return;
+        ChunkArena<char, CHAR_BITS> fresh{MemTag::WORDS};
+        for (uint32_t w = 0; w < refs_.size(); ++w) {
+            Ref& r = refs_[w];
+            if (!r.length) continue;
+            uint32_t offset = fresh.alloc(r.length);
+            std::copy(&chars_[r.offset], &chars_[r.offset] + r.length, &fresh[offset]);
+            r.offset = offset;
+        }
+        chars_ = std::move(fresh);
+        dead_bytes_ = 0;
+    }
+
+    std::string_view operator[](uint32_t w) const {
+        const Ref& r = refs_[w];
+        return r.length ? std::string_view(&chars_[r.offset], r.length) : std::string_view();
+    }
+
+    void clear() {
+        chars_.clear();
+        refs_.clear();
+        bytes_ = 0;
+        dead_bytes_ = 0;
+        free_ids_.clear();
+    }
+
+    size_t size() const { return refs_.size(); }
+    size_t live() const { return refs_.size() - free_ids_.size(); }
+    size_t chars_bytes() const { return bytes_; }
+    // Bytes usados: referencias + letras (sin la cola libre de los chunks)
+    size_t memory_bytes() const { return size() * sizeof(Ref) + bytes_; }
+    size_t capacity_bytes() const { return chars_.capacity_bytes() + refs_.capacity_bytes(); }
+};
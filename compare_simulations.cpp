@@ -1,4 +1,7 @@
 #include "trie.cpp"
+#include "double_array_trie.cpp"
+#include "corpus.cpp"
+#include "thread_pool.cpp"
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -21,9 +24,6 @@ bool create_directory(const std::string& path);
 // Función para listar archivos en directorio
 void list_directory(const std::string& path);
 
-// Función para cargar palabras desde archivo
-std::vector<std::string> load_words_from_file(const std::string& filename);
-
 // Estructura para resultados de simulación
 struct SimulationResult {
     size_t chars_written;    // Caracteres que el usuario tuvo que escribir
@@ -32,12 +32,15 @@ struct SimulationResult {
     double time_taken_ms;   // Tiempo que tomó procesar esta palabra
 };
 
-// Función para simular escritura de una palabra
-SimulationResult simulate_word_typing(Trie& trie, const std::string& word);
+// Función para simular escritura de una palabra (Trie o DoubleArrayTrie)
+template <class TrieT>
+SimulationResult simulate_word_typing(TrieT& trie, std::string_view word);
 
-// Función para ejecutar simulación completa
-void run_simulation(Trie& trie, const std::vector<std::string>& words, 
-                   const std::string& dataset_name, const std::string& variant_name);
+// Función para ejecutar simulación completa; el progreso va a `log`
+template <class TrieT>
+void run_simulation(TrieT& trie, Corpus::Reader& words, size_t L,
+                   const std::string& dataset_name, const std::string& variant_name,
+                   std::ostream& log);
 
 
 // IMPLEMENTACIONES DE FUNCIONES
@@ -74,126 +77,38 @@ void list_directory(const std::string& path) {
     }
 }
 
-// Función para cargar palabras desde un archivo .txt solo una linea no funciona con words.txt
-std::vector<std::string> load_words_from_file(const std::string& filename) {
-    std::vector<std::string> words;
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
-        return words;
-    }
-    
-    std::cout << "Cargando palabras desde " << filename << "..." << std::endl;
-    
-    std::string line;
-    int total_words = 0;
-    
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string word;
-        
-        // Dividir la línea en palabras individuales
-        while (ss >> word) {
-            // Limpiar la palabra: convertir a minúsculas y mantener solo letras
-            std::string clean_word;
-            for (char c : word) {
-                if (std::isalpha((unsigned char)c)) {
-                    clean_word.push_back(std::tolower((unsigned char)c));
-                }
-            }
-            
-            if (!clean_word.empty() && clean_word.length() >= 1) {
-                words.push_back(clean_word);
-                total_words++;
-                
-                if (total_words % 10000 == 0) {
-                    std::cout << "Cargadas " << total_words << " palabras..." << std::endl;
-                }
-            }
-        }
-    }
-    
-    file.close();
-    std::cout << "Total de palabras cargadas: " << total_words << std::endl;
-    return words;
-}
-
 // Función para simular la escritura de una palabra usando autocompletado
-SimulationResult simulate_word_typing(Trie& trie, const std::string& word) {
+template <class TrieT>
+SimulationResult simulate_word_typing(TrieT& trie, std::string_view word) {
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    Trie::Node* current = trie.root_;
-    size_t chars_typed = 0;
-    bool autocomplete_success = false;
-    
-    // Primero verificar si la palabra existe en el trie
-    Trie::Node* temp = trie.root_;
-    bool word_exists = true;
+    // Una sola pasada: la sugerencia se compara por identidad de nodo. Los
+    // prefijos cuya sugerencia es la palabra forman un tramo contiguo que
+    // termina en la palabra completa, así que basta recordar dónde empezó
+    // el tramo de la sugerencia actual y, al final, ver si es el terminal.
+    typename TrieT::Cursor cursor(trie);
+    typename TrieT::Node* previous = nullptr;
+    size_t run_start = 0;
     for (char c : word) {
-        temp = trie.descend(temp, c);
-        if (!temp) {
-            word_exists = false;
-            break;
+        if (!cursor.advance(c)) break;
+        typename TrieT::Node* suggestion = cursor.suggestion();
+        if (suggestion != previous) {
+            previous = suggestion;
+            run_start = cursor.depth;
         }
     }
     
-    if (word_exists) {
-        temp = trie.descend(temp, '$');
-        word_exists = (temp && temp->str && *temp->str == word);
-    }
-    
-    if (!word_exists) {
-        // Palabra no existe en el trie, usuario debe escribirla completa
-        auto end_time = std::chrono::high_resolution_clock::now();
-        double time_ms = std::chrono::duration_cast<std::chrono::microseconds>(
-            end_time - start_time).count() / 1000.0;
-        
-        return SimulationResult{word.length(), 0, false, time_ms};
-    }
-    
-    // La palabra existe, simular escritura con autocompletado
-    for (size_t i = 0; i < word.length(); ++i) {
-        char c = word[i];
-        Trie::Node* next_node = trie.descend(current, c);
-        
-        if (!next_node) {
-            // Esto no debería pasar si word_exists es true
-            chars_typed = word.length();
-            break;
-        }
-        
-        current = next_node;
-        chars_typed++;
-        
-        // Verificar autocompletado en el nodo actual
-        Trie::Node* autocomplete_node = trie.autocomplete(current);
-        if (autocomplete_node && autocomplete_node->str) {
-            std::string completed_word = *autocomplete_node->str;
-            
-            if (completed_word == word) {
-                // Autocompletado exitoso
-                autocomplete_success = true;
-                break;
-            }
-        }
-    }
+    typename TrieT::Node* terminal = cursor.valid() ? cursor.terminal() : nullptr;
+    bool autocomplete_success = terminal && previous == terminal;
+    size_t chars_typed = autocomplete_success ? run_start : word.length();
     
     auto end_time = std::chrono::high_resolution_clock::now();
-    double time_ms = std::chrono::duration_cast<std::chrono::microseconds>(
-        end_time - start_time).count() / 1000.0;
+    double time_ms = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time).count() / 1e6;
     
-    // Actualizar prioridad de la palabra
-    Trie::Node* word_node = trie.root_;
-    for (char c : word) {
-        word_node = trie.descend(word_node, c);
-        if (!word_node) break;
-    }
-    if (word_node) {
-        word_node = trie.descend(word_node, '$');
-        if (word_node && word_node->str && *word_node->str == word) {
-            trie.update_priority(word_node);
-        }
+    // Actualizar prioridad de la palabra, si existe en el trie
+    if (terminal) {
+        trie.update_priority(terminal);
     }
     
     return SimulationResult{
@@ -205,12 +120,13 @@ SimulationResult simulate_word_typing(Trie& trie, const std::string& word) {
 }
 
 // Función para ejecutar la simulación completa y exportar CSV
-void run_simulation(Trie& trie, const std::vector<std::string>& words, 
-                   const std::string& dataset_name, const std::string& variant_name) {
-    std::cout << "\n=== Simulación: " << dataset_name << " (" << variant_name << ") ===" << std::endl;
+template <class TrieT>
+void run_simulation(TrieT& trie, Corpus::Reader& words, size_t L,
+                   const std::string& dataset_name, const std::string& variant_name,
+                   std::ostream& log) {
+    log << "\n=== Simulación: " << dataset_name << " (" << variant_name << ") ===" << std::endl;
     
-    const size_t L = words.size();
-    std::cout << "Palabras a simular: " << L << std::endl;
+    log << "Palabras a simular: " << L << std::endl;
     
     std::vector<double> percentages;
     std::vector<double> simulation_times;
@@ -235,11 +151,11 @@ void run_simulation(Trie& trie, const std::vector<std::string>& words,
     size_t successful_autocompletes = 0;
     size_t words_not_in_trie = 0;
     
-    std::cout << "\nProgreso de la simulación:" << std::endl;
-    std::cout << "--------------------------" << std::endl;
+    log << "\nProgreso de la simulación:" << std::endl;
+    log << "--------------------------" << std::endl;
     
-    for (size_t i = 0; i < L; ++i) {
-        const std::string& word = words[i];
+    std::string_view word;
+    for (size_t i = 0; i < L && words.next(word); ++i) {
         total_chars_without_autocomplete += word.length();
         
         SimulationResult result = simulate_word_typing(trie, word);
@@ -262,7 +178,7 @@ void run_simulation(Trie& trie, const std::vector<std::string>& words,
             percentages.push_back(percentage);
             simulation_times.push_back(total_simulation_time_ms);
             
-            std::cout << "Palabra " << std::setw(8) << (i + 1) << ": " 
+            log << "Palabra " << std::setw(8) << (i + 1) << ": " 
                       << std::fixed << std::setprecision(2) << percentage 
                       << "% de caracteres escritos" << std::endl;
             
@@ -270,27 +186,27 @@ void run_simulation(Trie& trie, const std::vector<std::string>& words,
         }
         
         if ((i + 1) % 10000 == 0) {
-            std::cout << "Procesadas " << (i + 1) << " palabras..." << std::endl;
+            log << "Procesadas " << (i + 1) << " palabras..." << std::endl;
         }
     }
     
     // Resultados finales
-    std::cout << "\n=== Resultados Finales ===" << std::endl;
-    std::cout << "Dataset: " << dataset_name << std::endl;
-    std::cout << "Variante: " << variant_name << std::endl;
-    std::cout << "Total de palabras procesadas: " << L << std::endl;
-    std::cout << "Caracteres totales sin autocompletado: " << total_chars_without_autocomplete << std::endl;
-    std::cout << "Caracteres totales con autocompletado: " << total_chars_with_autocomplete << std::endl;
-    std::cout << "Ahorro total de caracteres: " << (total_chars_without_autocomplete - total_chars_with_autocomplete) << std::endl;
-    std::cout << "Porcentaje de caracteres escritos: " << std::fixed << std::setprecision(2) 
+    log << "\n=== Resultados Finales ===" << std::endl;
+    log << "Dataset: " << dataset_name << std::endl;
+    log << "Variante: " << variant_name << std::endl;
+    log << "Total de palabras procesadas: " << L << std::endl;
+    log << "Caracteres totales sin autocompletado: " << total_chars_without_autocomplete << std::endl;
+    log << "Caracteres totales con autocompletado: " << total_chars_with_autocomplete << std::endl;
+    log << "Ahorro total de caracteres: " << (total_chars_without_autocomplete - total_chars_with_autocomplete) << std::endl;
+    log << "Porcentaje de caracteres escritos: " << std::fixed << std::setprecision(2) 
               << (static_cast<double>(total_chars_with_autocomplete) / total_chars_without_autocomplete * 100.0) << "%" << std::endl;
-    std::cout << "Autocompletados exitosos: " << successful_autocompletes << "/" << L 
+    log << "Autocompletados exitosos: " << successful_autocompletes << "/" << L 
               << " (" << std::fixed << std::setprecision(2) 
               << (static_cast<double>(successful_autocompletes) / L * 100.0) << "%)" << std::endl;
-    std::cout << "Palabras no encontradas en el trie: " << words_not_in_trie << "/" << L 
+    log << "Palabras no encontradas en el trie: " << words_not_in_trie << "/" << L 
               << " (" << std::fixed << std::setprecision(2) 
               << (static_cast<double>(words_not_in_trie) / L * 100.0) << "%)" << std::endl;
-    std::cout << "Tiempo total de simulación: " << std::fixed << std::setprecision(2) 
+    log << "Tiempo total de simulación: " << std::fixed << std::setprecision(2) 
               << total_simulation_time_ms << " ms" << std::endl;
     
     // Exportar datos para graficar
@@ -304,23 +220,34 @@ void run_simulation(Trie& trie, const std::vector<std::string>& words,
                        << std::fixed << std::setprecision(2) << simulation_times[i] << "\n";
         }
         output_file.close();
-        std::cout << "Datos exportados a: " << output_filename << std::endl;
+        log << "Datos exportados a: " << output_filename << std::endl;
     } else {
-        std::cerr << "Error: No se pudo crear el archivo " << output_filename << std::endl;
+        log << "Error: No se pudo crear el archivo " << output_filename << std::endl;
     }
 }
 
 // FUNCIÓN PRINCIPAL
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Con "doble" se simula sobre DoubleArrayTrie (csv: <variante>-doble)
+    bool use_double = (argc == 2 && std::string(argv[1]) == "doble");
+    if (argc > 2 || (argc == 2 && !use_double)) {
+        std::cout << "Uso: ./compare [doble]\n";
+        std::cout << "  doble: usar el trie de doble arreglo BASE/CHECK (DoubleArrayTrie)\n";
+        return 1;
+    }
+
     std::vector<std::string> datasets = {
         "textos/wikipedia.txt",
         "textos/random.txt", 
         "textos/random_with_distribution.txt"
     };
     
+    // El decaimiento es una política del trie normal; DoubleArrayTrie solo
+    // tiene los dos modos de siempre
     std::vector<std::string> variants = {"reciente", "frecuente"};
+    if (!use_double) variants.push_back("decaimiento");
     
     // Crear carpeta resultados si no existe
     if (!create_directory("resultados")) {
@@ -332,45 +259,96 @@ int main() {
     std::cout << "Carpeta de resultados: resultados/" << std::endl;
     std::cout << "Se generarán archivos: results_<dataset>_<variante>.csv" << std::endl;
     
+    // Cada dataset se carga una sola vez y lo comparten (solo lectura) los
+    // trabajos de todas las variantes
+    std::vector<Corpus> corpora;
+    std::vector<std::string> dataset_files, dataset_names;
     for (const auto& dataset_file : datasets) {
-        for (const auto& variant : variants) {
-            std::cout << "\n" << std::string(60, '=') << std::endl;
-            std::cout << "PROCESANDO: " << dataset_file << " - " << variant << std::endl;
-            std::cout << std::string(60, '=') << std::endl;
-            
-            // Cargar palabras
-            auto words = load_words_from_file(dataset_file);
-            if (words.empty()) {
-                std::cerr << "Error al cargar " << dataset_file << std::endl;
-                continue;
-            }
-            
-            // Limitar tamaño para pruebas (cambiar signo de < a > para limitar)
-            const size_t MAX_WORDS = 100000;
-            if (words.size() < MAX_WORDS) {
-                std::cout << "Limiting to " << MAX_WORDS << " words for testing..." << std::endl;
-                words.resize(MAX_WORDS);
-            }
-            
-            // Construir trie
-            Trie::Variant trie_variant = (variant == "reciente") ? 
-                Trie::Variant::MOST_RECENT : Trie::Variant::MOST_FREQUENT;
-            Trie trie(trie_variant);
-            
-            std::cout << "Construyendo trie..." << std::endl;
+        auto words = load_corpus(dataset_file, Corpus::Split::WHITESPACE);
+        if (words.empty()) {
+            std::cerr << "Error al cargar " << dataset_file << std::endl;
+            continue;
+        }
+        
+        // Limitar tamaño para pruebas (cambiar signo de < a > para limitar)
+        const size_t MAX_WORDS = 100000;
+        if (words.size() < MAX_WORDS) {
+            std::cout << "Limiting to " << MAX_WORDS << " words for testing..." << std::endl;
+            words.truncate(MAX_WORDS);
+        }
+        
+        std::string dataset_name = dataset_file.substr(dataset_file.find('/') + 1);
+        dataset_name = dataset_name.substr(0, dataset_name.find('.'));
+        corpora.push_back(std::move(words));
+        dataset_files.push_back(dataset_file);
+        dataset_names.push_back(dataset_name);
+    }
+    
+    // Un trabajo por (dataset, variante), cada uno con su trie, su csv y su
+    // buffer de log para que la salida no se mezcle
+    struct Job {
+        size_t dataset;
+        std::string variant;
+        std::ostringstream log;
+    };
+    std::vector<Job> jobs(corpora.size() * variants.size());
+    for (size_t d = 0; d < corpora.size(); ++d) {
+        for (size_t v = 0; v < variants.size(); ++v) {
+            jobs[d * variants.size() + v].dataset = d;
+            jobs[d * variants.size() + v].variant = variants[v];
+        }
+    }
+    
+    size_t threads = default_thread_count(jobs.size());
+    std::cout << "\nEjecutando " << jobs.size() << " simulaciones en " << threads << " hilos..." << std::endl;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    parallel_for(jobs.size(), threads, [&](size_t j) {
+        Job& job = jobs[j];
+        const Corpus& words = corpora[job.dataset];
+        std::ostream& log = job.log;
+        
+        log << "\n" << std::string(60, '=') << std::endl;
+        log << "PROCESANDO: " << dataset_files[job.dataset] << " - " << job.variant << std::endl;
+        log << std::string(60, '=') << std::endl;
+        
+        // Construir trie
+        TrieTypes::Variant trie_variant = (job.variant == "reciente") ? TrieTypes::Variant::MOST_RECENT :
+                                          (job.variant == "decaimiento") ? TrieTypes::Variant::DECAYED :
+                                                                           TrieTypes::Variant::MOST_FREQUENT;
+        auto build_and_simulate = [&](auto& trie, const std::string& variant_name) {
+            log << "Construyendo trie..." << std::endl;
             for (size_t i = 0; i < words.size(); ++i) {
                 trie.insert(words[i]);
                 if ((i + 1) % 10000 == 0) {
-                    std::cout << "Insertadas " << (i + 1) << " palabras..." << std::endl;
+                    log << "Insertadas " << (i + 1) << " palabras..." << std::endl;
                 }
             }
             
             // Ejecutar simulación
-            std::string dataset_name = dataset_file.substr(dataset_file.find('/') + 1);
-            dataset_name = dataset_name.substr(0, dataset_name.find('.'));
-            run_simulation(trie, words, dataset_name, variant);
+            Corpus::Reader reader(words);
+            run_simulation(trie, reader, words.size(), dataset_names[job.dataset], variant_name, log);
+        };
+        if (use_double) {
+            DoubleArrayTrie trie(trie_variant);
+            build_and_simulate(trie, job.variant + "-doble");
+        } else {
+            with_ranking(trie_variant, [&](auto ranking) {
+                Trie<decltype(ranking)> trie;
+                build_and_simulate(trie, job.variant);
+            });
         }
+    });
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    
+    // Volcar los logs en el orden de siempre
+    for (const Job& job : jobs) {
+        std::cout << job.log.str();
     }
+    std::cout << "\nTiempo total (pared): "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()
+              << " ms" << std::endl;
     
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "COMPARACIÓN FINALIZADA" << std::endl;
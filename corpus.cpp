@@ -0,0 +1,285 @@
+#pragma once
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "memory_stats.cpp"
+#include "tokenizer.cpp"
+
+// Corpus cargado con mmap y tokenizado en el lugar: cada token se normaliza
+// (solo letras, en minúscula) compactándolo hacia la izquierda dentro del
+// mismo mapeo privado, y la tabla de tokens guarda offset + largo de 32 bits.
+// La normalización la hace Tokenizer (tokenizer.cpp), de a 64 bytes, con
+// las letras del alfabeto elegido (alphabet.cpp; por defecto ASCII).
+// Las palabras se entregan como string_view sobre ese buffer, sin una
+// asignación de memoria por palabra.
+
+class Corpus {
+public:
+    // LINES: una palabra por línea (words.txt), WHITESPACE: texto corrido
+    enum class Split { LINES, WHITESPACE };
+
+    struct Token {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    Corpus() = default;
+    Corpus(const Corpus&) = delete;
+    Corpus& operator=(const Corpus&) = delete;
+    Corpus(Corpus&& other) noexcept { *this = std::move(other); }
+    Corpus& operator=(Corpus&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = other.data_;
+            mapped_ = other.mapped_;
+            tokens_ = std::move(other.tokens_);
+            other.data_ = nullptr;
+            other.mapped_ = 0;
+        }
+        return *this;
+    }
+    ~Corpus() { unmap(); }
+
+    // Mapea y tokeniza el archivo; descarta tokens con menos de min_length letras
+    template <class Alphabet = AsciiAlphabet>
+    bool open(const std::string& filename, Split split, size_t min_length) {
+        unmap();
+        tokens_.clear();
+
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        if (st.st_size == 0) {
+            ::close(fd);
+            return true;
+        }
+        if (static_cast<uint64_t>(st.st_size) > UINT32_MAX) {
+            std::cerr << "Error: " << filename << " supera 4 GB" << std::endl;
+            ::close(fd);
+            return false;
+        }
+
+        // Mapeo privado: las escrituras de la normalización no tocan el archivo
+        void* p = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        data_ = static_cast<char*>(p);
+        mapped_ = static_cast<size_t>(st.st_size);
+        madvise(data_, mapped_, MADV_SEQUENTIAL);
+
+        tokenize<Alphabet>(split, min_length);
+        return true;
+    }
+
+    size_t size() const { return tokens_.size(); }
+    bool empty() const { return tokens_.empty(); }
+
+    std::string_view operator[](size_t i) const {
+        return std::string_view(data_ + tokens_[i].offset, tokens_[i].length);
+    }
+
+    // Deja solo las primeras n palabras
+    void truncate(size_t n) {
+        if (n < tokens_.size()) tokens_.resize(n);
+    }
+
+    // Bytes propios: tabla de tokens + mapeo del archivo
+    size_t memory_bytes() const { return tokens_.capacity() * sizeof(Token) + mapped_; }
+    size_t mapped_bytes() const { return mapped_; }
+
+    struct iterator {
+        const Corpus* corpus;
+        size_t i;
+        std::string_view operator*() const { return (*corpus)[i]; }
+        iterator& operator++() { ++i; return *this; }
+        bool operator!=(const iterator& o) const { return i != o.i; }
+    };
+    iterator begin() const { return iterator{this, 0}; }
+    iterator end() const { return iterator{this, tokens_.size()}; }
+
+    static bool is_separator(unsigned char c, Split split) {
+        return Tokenizer::is_separator(c, split == Split::WHITESPACE);
+    }
+
+    // Recorre un Corpus ya cargado con la misma interfaz que TokenStream
+    class Reader {
+    public:
+        explicit Reader(const Corpus& corpus) : corpus_(&corpus) {}
+
+        bool next(std::string_view& w) {
+            if (i_ >= corpus_->size()) return false;
+            w = (*corpus_)[i_++];
+            return true;
+        }
+        void rewind() { i_ = 0; }
+        size_t count() const { return i_; }
+
+    private:
+        const Corpus* corpus_;
+        size_t i_ = 0;
+    };
+
+private:
+    char* data_ = nullptr;
+    size_t mapped_ = 0;
+    std::vector<Token> tokens_;
+
+    void unmap() {
+        if (data_) munmap(data_, mapped_);
+        data_ = nullptr;
+        mapped_ = 0;
+    }
+
+    // La posición de escritura nunca pasa a la de lectura, así que se puede
+    // compactar sobre el mismo buffer
+    template <class Alphabet>
+    void tokenize(Split split, size_t min_length) {
+        MemTagScope scope(MemTag::LOADER);
+        Tokenizer::run<Alphabet>(Tokenizer::kernel(), data_, mapped_, split == Split::WHITESPACE, min_length, true,
+                       [&](size_t offset, size_t length) {
+                           tokens_.push_back(Token{static_cast<uint32_t>(offset), static_cast<uint32_t>(length)});
+                       });
+    }
+};
+
+// Cargador compartido por todos los ejecutables
+template <class Alphabet = AsciiAlphabet>
+Corpus load_corpus(const std::string& filename, Corpus::Split split, size_t min_length = 1) {
+    Corpus corpus;
+    std::cout << "Cargando palabras desde " << filename << "..." << std::endl;
+    if (!corpus.template open<Alphabet>(filename, split, min_length)) {
+        std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
+        return corpus;
+    }
+    std::cout << "Total de palabras cargadas: " << corpus.size() << std::endl;
+    return corpus;
+}
+
+// Lectura en streaming con un buffer de tamaño fijo: nunca materializa el
+// corpus completo. Cada vez que se vacía, el buffer se rellena desde el
+// archivo y se tokeniza de una vez con Tokenizer, igual que Corpus; la
+// palabra cortada al final del buffer queda pendiente (ya normalizada) y se
+// mueve al inicio para el siguiente relleno. La string_view entregada por
+// next() vale hasta la siguiente llamada. rewind() vuelve al inicio del
+// archivo para una segunda pasada.
+template <class Alphabet>
+class BasicTokenStream {
+public:
+    static constexpr size_t DEFAULT_BUFFER_BYTES = 1 << 20;
+
+    BasicTokenStream(Corpus::Split split, size_t min_length, size_t buffer_bytes = DEFAULT_BUFFER_BYTES)
+        : split_(split), min_length_(min_length) {
+        MemTagScope scope(MemTag::LOADER);
+        buf_.resize(buffer_bytes);
+    }
+    BasicTokenStream(const BasicTokenStream&) = delete;
+    BasicTokenStream& operator=(const BasicTokenStream&) = delete;
+    ~BasicTokenStream() { if (fd_ >= 0) ::close(fd_); }
+
+    bool open(const std::string& filename) {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = ::open(filename.c_str(), O_RDONLY);
+        rewind();
+        return fd_ >= 0;
+    }
+
+    bool next(std::string_view& w) {
+        while (next_ == tokens_.size()) {
+            if (!refill()) return false;
+        }
+        const Corpus::Token& t = tokens_[next_++];
+        w = std::string_view(buf_.data() + t.offset, t.length);
+        ++count_;
+        return true;
+    }
+
+    void rewind() {
+        if (fd_ >= 0) lseek(fd_, 0, SEEK_SET);
+        tokens_.clear();
+        next_ = 0;
+        pending_begin_ = pending_end_ = 0;
+        held_ = 0;
+        eof_ = (fd_ < 0);
+        count_ = 0;
+    }
+
+    // Palabras entregadas desde el último rewind()
+    size_t count() const { return count_; }
+    size_t buffer_bytes() const { return buf_.size(); }
+
+private:
+    Corpus::Split split_;
+    size_t min_length_;
+    std::vector<char> buf_;
+    std::vector<Corpus::Token> tokens_;   // tokens listos en buf_
+    size_t next_ = 0;
+    size_t pending_begin_ = 0;            // palabra cortada por el final del buffer
+    size_t pending_end_ = 0;
+    size_t held_ = 0;                     // inicio de secuencia UTF-8 cortado (0 o 1 byte)
+    char held_byte_ = 0;
+    int fd_ = -1;
+    bool eof_ = true;
+    size_t count_ = 0;
+
+    // Mueve la palabra pendiente al inicio, completa el buffer desde el
+    // archivo y lo tokeniza; false cuando ya no queda nada
+    bool refill() {
+        MemTagScope scope(MemTag::LOADER);
+        tokens_.clear();
+        next_ = 0;
+        size_t normalized = pending_end_ - pending_begin_;
+        size_t end = normalized;
+        if (eof_ && end == 0 && held_ == 0) return false;
+        std::memmove(buf_.data(), buf_.data() + pending_begin_, end);
+        pending_begin_ = pending_end_ = 0;
+
+        // Una palabra que ocupa el buffer entero se corta ahí
+        if (end == buf_.size()) {
+            if (end >= min_length_) tokens_.push_back(Corpus::Token{0, static_cast<uint32_t>(end)});
+            return true;
+        }
+        if (held_) {
+            buf_[end++] = held_byte_;
+            held_ = 0;
+        }
+        while (!eof_ && end < buf_.size()) {
+            ssize_t n = ::read(fd_, buf_.data() + end, buf_.size() - end);
+            if (n <= 0) {
+                eof_ = true;
+            } else {
+                end += static_cast<size_t>(n);
+            }
+        }
+
+        // Una letra UTF-8 cortada por el final del buffer espera al relleno
+        // siguiente para decodificarse entera
+        if (Alphabet::UTF8 && !eof_ && end > normalized && static_cast<unsigned char>(buf_[end - 1]) >= 0xC0) {
+            held_byte_ = buf_[--end];
+            held_ = 1;
+        }
+
+        pending_begin_ = Tokenizer::run<Alphabet>(
+            Tokenizer::kernel(), buf_.data(), end, split_ == Corpus::Split::WHITESPACE, min_length_, eof_,
+            [&](size_t offset, size_t length) {
+                tokens_.push_back(Corpus::Token{static_cast<uint32_t>(offset), static_cast<uint32_t>(length)});
+            },
+            &pending_end_, normalized);
+        return true;
+    }
+};
+
+typedef BasicTokenStream<AsciiAlphabet> TokenStream;
@@ -0,0 +1,383 @@
+#pragma once
+#include <iomanip>
+
+#include "trie.cpp"
+
+// Trie de doble arreglo (BASE/CHECK): el hijo de s con código c es la celda
+// t = base[s] + c y es válido si check[t] == s, así que cada tecla es una
+// suma y una comparación sobre un único arreglo contiguo, sin bloques de
+// hijos. check[t] es además el padre de t, con lo que update_priority sube
+// hacia la raíz sin un campo extra.
+//
+// En arreglos paralelos indexados por estado quedan best_ (palabra del mejor
+// terminal del subárbol) y word_ (palabra del terminal '$'); por palabra,
+// word_priority_ y terminal_state_. Guardar palabras y no estados en best_
+// permite mover estados al resolver colisiones sin tocar a los ancestros.
+// Misma semántica de insert / update_priority / autocomplete que Trie.
+
+struct DoubleArrayTrie {
+    // --------------------------------------------------------
+    // Tipos y estructuras
+    // --------------------------------------------------------
+    typedef TrieTypes::Variant Variant;
+    typedef TrieTypes::Id Id;
+    static constexpr Id NONE = TrieTypes::NONE;
+    static constexpr Id EMPTY = 0xFFFFFFFEu;     // check de una celda libre
+    static constexpr Id NUM_CODES = 28;          // código = letra + 1 ('$' es 27)
+    static constexpr size_t MAX_BASE_TRIES = 256;
+    static constexpr uint8_t MAX_FREE_FAILS = 16;
+
+    // Celda del doble arreglo. Node* sirve de identidad del estado para
+    // Cursor y update_priority, y vale hasta el próximo insert()
+    struct Node {
+        Id base = 0;                   // 0: sin hijos
+        Id check = EMPTY;              // padre (la raíz es su propio padre)
+    };
+
+    // --------------------------------------------------------
+    // Atributos del trie
+    // --------------------------------------------------------
+    Variant variant;
+    int64_t access_counter_ = 0;       // para modo reciente
+    size_t node_count_ = 0;            // estados usados
+    size_t total_chars_ = 0;           // total de caracteres insertados
+    WordPool words_;                   // palabras en orden de primera inserción
+
+    std::vector<Node> units_;
+    std::vector<Id> best_;             // por estado: palabra del mejor terminal
+    std::vector<Id> word_;             // por estado: palabra del '$' (NONE si no es terminal)
+    std::vector<int64_t> word_priority_;   // por palabra
+    std::vector<Id> terminal_state_;       // por palabra: su estado '$'
+
+    // Celdas libres en una lista doble circular (free_next_/free_prev_). Un
+    // hueco que falla MAX_FREE_FAILS veces como base sale de la lista (sigue
+    // libre, pero ya no se prueba) para que la búsqueda no se estanque
+    std::vector<Id> free_next_, free_prev_;
+    std::vector<uint8_t> free_fails_;
+    Id free_head_ = NONE;
+
+    // --------------------------------------------------------
+    // Constructor
+    // --------------------------------------------------------
+    DoubleArrayTrie(Variant v) : variant(v) {
+        reset(v);
+    }
+
+    void reset(Variant v) {
+        variant = v;
+        units_.clear();
+        best_.clear();
+        word_.clear();
+        word_priority_.clear();
+        terminal_state_.clear();
+        free_next_.clear();
+        free_prev_.clear();
+        free_fails_.clear();
+        free_head_ = NONE;
+        words_.clear();
+        access_counter_ = 0;
+        total_chars_ = 0;
+        node_count_ = 0;
+        grow(256);
+        take(0, 0);                    // la raíz es el estado 0
+    }
+
+    // --------------------------------------------------------
+    // Funciones auxiliares
+    // --------------------------------------------------------
+    static Id code_of(char c) {
+        int k = alphabet_index<AsciiAlphabet>(c);
+        return k < 0 ? NONE : static_cast<Id>(k + 1);
+    }
+
+    Node* unit(Id s) { return s == NONE ? nullptr : &units_[s]; }
+    const Node* unit(Id s) const { return s == NONE ? nullptr : &units_[s]; }
+    Id state_of(const Node* n) const { return static_cast<Id>(n - units_.data()); }
+
+    std::string_view word(const Node* terminal) const { return words_[word_[state_of(terminal)]]; }
+
+    // Transición O(1); la última celda siempre deja lugar a base + NUM_CODES
+    Id child(Id s, Id code) const {
+        Id t = units_[s].base + code;
+        return units_[t].check == s ? t : NONE;
+    }
+
+    // --------------------------------------------------------
+    // Operaciones principales
+    // --------------------------------------------------------
+
+    // Inserta una palabra y retorna su nodo terminal
+    Node* insert(std::string_view w_raw) {
+        // Misma normalización que Trie::insert (Tokenizer::normalize_word)
+        if (!Tokenizer::is_normalized<AsciiAlphabet>(w_raw))
+            return insert(Tokenizer::normalize_word<AsciiAlphabet>(w_raw));
+        if (w_raw.size() > WordPool::MAX_LENGTH) {
+            std::cerr << "Error: palabra de más de " << WordPool::MAX_LENGTH << " letras, no se inserta" << std::endl;
+            return nullptr;
+        }
+        Id s = 0;
+        for (char c : w_raw) s = ensure_child(s, code_of(c));
+        size_t letters = w_raw.size();
+
+        if (letters == 0) return nullptr;
+        total_chars_ += letters + 1; // caracteres + '$', igual que Trie
+
+        Id t = child(s, code_of('$'));
+        if (t == NONE) {
+            t = ensure_child(s, code_of('$'));
+            word_[t] = words_.append(w_raw);
+            word_priority_.push_back(0);
+            terminal_state_.push_back(t);
+            propagate_if_better(t);
+        }
+        return &units_[t];
+    }
+
+    Node* root() { return &units_[0]; }
+
+    // Avanza un carácter desde el estado s (NONE si no hay palabras)
+    Id descend(Id s, char c) const {
+        if (s == NONE) return NONE;
+        Id code = code_of(c);   // la tabla del alfabeto ya acepta mayúsculas
+        return code == NONE ? NONE : child(s, code);
+    }
+
+    // Terminal de la mejor palabra del subárbol de s
+    Node* autocomplete(Id s) {
+        if (s == NONE || best_[s] == NONE) return nullptr;
+        return &units_[terminal_state_[best_[s]]];
+    }
+
+    // Misma interfaz que Trie::Cursor, avanzando sobre estados
+    struct Cursor {
+        DoubleArrayTrie* trie;
+        Id state = 0;
+        Node* term = nullptr;
+        size_t depth = 0;
+
+        explicit Cursor(DoubleArrayTrie& t) : trie(&t) {}
+
+        bool advance(char c) {
+            state = trie->descend(state, c);
+            term = nullptr;
+            if (state == NONE) return false;
+            ++depth;
+            return true;
+        }
+
+        bool valid() const { return state != NONE; }
+        Node* node() const { return trie->unit(state); }
+        Node* suggestion() const { return trie->autocomplete(state); }
+
+        Node* terminal() {
+            if (!term && state != NONE) term = trie->unit(trie->descend(state, '$'));
+            return term;
+        }
+    };
+
+    // Igual que Trie::update_priority: prioridades solo crecen, así que se
+    // puede cortar en el primer ancestro que ya es mejor
+    void update_priority(Node* terminal) {
+        Id t = state_of(terminal);
+        Id w = word_[t];
+        assert(w != NONE);
+
+        if (variant == Variant::MOST_RECENT) {
+            word_priority_[w] = ++access_counter_;
+        } else {
+            word_priority_[w] += 1;
+        }
+        int64_t p = word_priority_[w];
+
+        best_[t] = w;
+        for (Id cur = units_[t].check; ; cur = units_[cur].check) {
+            // Si ya era w hay que seguir subiendo: su prioridad vieja era menor
+            Id b = best_[cur];
+            bool needs_update = b == NONE || b == w || p > word_priority_[b] ||
+                (p == word_priority_[b] && b != w && variant == Variant::MOST_RECENT);
+            if (!needs_update) break;
+            best_[cur] = w;
+            if (cur == 0) break;
+        }
+    }
+
+    // --------------------------------------------------------
+    // Métricas
+    // --------------------------------------------------------
+    size_t node_count() const { return node_count_; }
+    size_t total_chars() const { return total_chars_; }
+    size_t word_count() const { return words_.size(); }
+
+    // Bytes por celda: unidad + best_ + word_ (las listas libres solo
+    // sirven para insertar)
+    size_t approx_memory_bytes() const {
+        return units_.size() * (sizeof(Node) + 2 * sizeof(Id)) +
+               word_priority_.size() * (sizeof(int64_t) + sizeof(Id)) + words_.memory_bytes();
+    }
+
+    void print_stats() const {
+        std::cout << "=== Estadísticas del Trie de doble arreglo ===" << std::endl;
+        std::cout << "Nodos totales: " << node_count_ << std::endl;
+        std::cout << "Palabras almacenadas: " << words_.size() << std::endl;
+        std::cout << "Caracteres totales insertados: " << total_chars_ << std::endl;
+        std::cout << "Celdas: " << units_.size() << " (ocupación " << std::fixed << std::setprecision(2)
+                  << (100.0 * node_count_ / units_.size()) << "%)" << std::endl;
+        std::cout << "Memoria aproximada: " << approx_memory_bytes() << " bytes" << std::endl;
+        std::cout << "Memoria aproximada: " << approx_memory_bytes() / 1024.0 / 1024.0 << " MB" << std::endl;
+        std::cout << "Modo: " << (variant == Variant::MOST_RECENT ? "MÁS RECIENTE" : "MÁS FRECUENTE") << std::endl;
+        std::cout << "=============================================" << std::endl;
+    }
+
+private:
+
+    // Agrega n celdas libres al final
+    void grow(size_t n) {
+        MemTagScope scope(MemTag::NODES);
+        size_t old = units_.size();
+        units_.resize(old + n);
+        best_.resize(old + n, NONE);
+        word_.resize(old + n, NONE);
+        free_next_.resize(old + n);
+        free_prev_.resize(old + n);
+        free_fails_.resize(old + n, 0);
+        for (size_t i = old; i < old + n; ++i) push_free(static_cast<Id>(i));
+    }
+
+    void push_free(Id i) {
+        if (free_head_ == NONE) {
+            free_head_ = free_next_[i] = free_prev_[i] = i;
+            return;
+        }
+        Id tail = free_prev_[free_head_];
+        free_next_[tail] = i;
+        free_prev_[i] = tail;
+        free_next_[i] = free_head_;
+        free_prev_[free_head_] = i;
+    }
+
+    void unlink_free(Id i) {
+        if (free_next_[i] == i) {
+            free_head_ = NONE;
+        } else {
+            free_next_[free_prev_[i]] = free_next_[i];
+            free_prev_[free_next_[i]] = free_prev_[i];
+            if (free_head_ == i) free_head_ = free_next_[i];
+        }
+        free_next_[i] = NONE;
+    }
+
+    // Ocupa la celda libre i como estado hijo de parent
+    void take(Id i, Id parent) {
+        if (free_next_[i] != NONE) unlink_free(i);
+        units_[i].base = 0;
+        units_[i].check = parent;
+        best_[i] = NONE;
+        word_[i] = NONE;
+        ++node_count_;
+    }
+
+    void release(Id i) {
+        units_[i].base = 0;
+        units_[i].check = EMPTY;
+        best_[i] = NONE;
+        word_[i] = NONE;
+        free_fails_[i] = 0;
+        push_free(i);
+        --node_count_;
+    }
+
+    // Base con lugar libre para todos los códigos (ordenados). Prueba
+    // celdas de la lista libre; si ninguna sirve, usa el final del arreglo
+    Id find_base(const std::vector<Id>& codes) {
+        Id candidate = free_head_;
+        for (size_t tries = 0; candidate != NONE && tries < MAX_BASE_TRIES; ++tries) {
+            Id next = free_next_[candidate];
+            if (candidate > codes[0]) {
+                Id b = candidate - codes[0];
+                bool fits = true;
+                for (Id c : codes) {
+                    if (b + c >= units_.size() || units_[b + c].check != EMPTY) {
+                        fits = false;
+                        break;
+                    }
+                }
+                if (fits) return b;
+            }
+            // El que falla va al final (o sale si ya falló demasiado), así la
+            // próxima búsqueda empieza por huecos distintos
+            unlink_free(candidate);
+            if (++free_fails_[candidate] < MAX_FREE_FAILS) push_free(candidate);
+            if (free_head_ == NONE) break;
+            candidate = (next == candidate) ? free_head_ : next;
+        }
+        return static_cast<Id>(units_.size());
+    }
+
+    // Deja espacio para base + NUM_CODES, así child() nunca se sale
+    void reserve_base(Id b) {
+        if (b + NUM_CODES > units_.size())
+            grow(b + NUM_CODES - units_.size());
+    }
+
+    Id ensure_child(Id s, Id code) {
+        Id base = units_[s].base;
+        if (base != 0) {
+            Id t = base + code;
+            if (units_[t].check == s) return t;
+            if (units_[t].check == EMPTY) {
+                take(t, s);
+                return t;
+            }
+            relocate(s, code);
+        } else {
+            Id b = find_base({code});
+            reserve_base(b);
+            units_[s].base = b;
+        }
+        Id t = units_[s].base + code;
+        take(t, s);
+        return t;
+    }
+
+    // Colisión al agregar `code` a s: mueve todos los hijos de s a una base
+    // donde quepan junto con el nuevo. Los nietos se reenganchan cambiando
+    // su check, y terminal_state_ sigue a los terminales movidos
+    void relocate(Id s, Id code) {
+        Id old_base = units_[s].base;
+        std::vector<Id> codes;
+        for (Id c = 1; c < NUM_CODES; ++c) {
+            if (c == code || units_[old_base + c].check == s) codes.push_back(c);
+        }
+        Id b = find_base(codes);
+        reserve_base(b);
+
+        for (Id c : codes) {
+            if (c == code) continue;
+            Id from = old_base + c, to = b + c;
+            take(to, s);
+            units_[to].base = units_[from].base;
+            best_[to] = best_[from];
+            word_[to] = word_[from];
+            if (word_[to] != NONE) terminal_state_[word_[to]] = to;
+            Id grand = units_[from].base;
+            if (grand != 0) {
+                for (Id g = 1; g < NUM_CODES; ++g) {
+                    if (units_[grand + g].check == from) units_[grand + g].check = to;
+                }
+            }
+            release(from);
+        }
+        units_[s].base = b;
+    }
+
+    void propagate_if_better(Id t) {
+        Id w = word_[t];
+        int64_t p = word_priority_[w];
+        best_[t] = w;
+        for (Id cur = units_[t].check; ; cur = units_[cur].check) {
+            if (best_[cur] != NONE && p <= word_priority_[best_[cur]]) break;
+            best_[cur] = w;
+            if (cur == 0) break;
+        }
+    }
+};
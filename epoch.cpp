@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <utility>
+
+// Acceso a campos que un escritor modifica mientras otros hilos leen.
+// Con memory_order_relaxed compilan a un mov normal en x86, así que el
+// camino de un solo hilo no paga nada por usarlos.
+template <class T>
+inline T load_shared(const T& x, std::memory_order mo = std::memory_order_relaxed) {
+    return std::atomic_ref<T>(const_cast<T&>(x)).load(mo);
+}
+
+template <class T>
+inline void store_shared(T& x, T v, std::memory_order mo = std::memory_order_relaxed) {
+    std::atomic_ref<T>(x).store(v, mo);
+}
+
+// Reclamación por épocas (EBR) para un escritor y varios lectores.
+// Cada lector anuncia la época global al entrar a una consulta (Guard) y la
+// suelta al salir. Lo que el escritor desengancha se retira con la época
+// actual y se libera recién cuando la época global avanzó dos veces: para
+// entonces ningún lector que pudo verlo sigue adentro.
+class EpochManager {
+public:
+    static const int MAX_READERS = 64;
+
+    EpochManager() = default;
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+    ~EpochManager() { drain(); }
+
+    // Slot para un hilo lector (-1 si no quedan)
+    int register_reader() {
+        for (int i = 0; i < MAX_READERS; ++i) {
+            bool expected = false;
+            if (slots_[i].used.compare_exchange_strong(expected, true)) return i;
+        }
+        return -1;
+    }
+    void unregister_reader(int slot) { slots_[slot].used.store(false, std::memory_order_release); }
+
+    void enter(int slot) {
+        slots_[slot].epoch.store(global_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    void exit(int slot) { slots_[slot].epoch.store(IDLE, std::memory_order_release); }
+
+    // Marca una consulta de lector: nada de lo que vea se libera mientras dure
+    struct Guard {
+        EpochManager& epoch;
+        int slot;
+        Guard(EpochManager& e, int s) : epoch(e), slot(s) { epoch.enter(slot); }
+        ~Guard() { epoch.exit(slot); }
+    };
+
+    // Escritor: fn libera (o recicla) algo que ya no es alcanzable
+    void retire(std::function<void()> fn) {
+        limbo_.emplace_back(global_.load(std::memory_order_relaxed), std::move(fn));
+        if (limbo_.size() >= COLLECT_EVERY) collect();
+    }
+
+    // Escritor: avanza la época si se puede y libera lo que ya es seguro
+    void collect() {
+        try_advance();
+        uint64_t g = global_.load(std::memory_order_relaxed);
+        while (!limbo_.empty() && limbo_.front().first + 2 <= g) {
+            limbo_.front().second();
+            limbo_.pop_front();
+        }
+    }
+
+    // Escritor: espera a que todo lo retirado se libere
+    void drain() {
+        while (!limbo_.empty()) {
+            collect();
+            if (!limbo_.empty()) std::this_thread::yield();
+        }
+    }
+
+    size_t pending() const { return limbo_.size(); }
+    uint64_t epoch() const { return global_.load(std::memory_order_relaxed); }
+
+private:
+    static const uint64_t IDLE = ~0ull;
+    static const size_t COLLECT_EVERY = 64;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{IDLE};
+        std::atomic<bool> used{false};
+    };
+
+    std::atomic<uint64_t> global_{1};
+    Slot slots_[MAX_READERS];
+    std::deque<std::pair<uint64_t, std::function<void()>>> limbo_;   // solo el escritor
+
+    // La época avanza si todos los lectores activos ya vieron la actual
+    bool try_advance() {
+        uint64_t g = global_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (const Slot& s : slots_) {
+            uint64_t e = s.epoch.load(std::memory_order_acquire);
+            if (e != IDLE && e != g) return false;
+        }
+        global_.store(g + 1, std::memory_order_release);
+        return true;
+    }
+};
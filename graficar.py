@@ -9,6 +9,17 @@ import seaborn as sns
 plt.style.use('seaborn-v0_8')
 sns.set_palette("husl")
 
+# Color, línea y marcador de cada variante (las de otro backend, como
+# reciente-doble, usan el de su modo)
+ESTILOS = {
+    'reciente': ('red', '--', 'o'),
+    'frecuente': ('blue', '-', 's'),
+    'decaimiento': ('green', '-.', '^'),
+}
+
+def estilo_variante(variante):
+    return ESTILOS.get(variante.split('-')[0], ('gray', ':', 'x'))
+
 def cargar_datos_metricas():
     """Carga y organiza los datos de los archivos CSV"""
     archivos_csv = glob.glob("resultados/results_*.csv")
@@ -93,9 +104,7 @@ def graficar_nodos_normalizados(metricas_completas):
         variantes = metricas_completas[dataset]
         
         for variante, df in variantes.items():
-            color = 'red' if variante == 'reciente' else 'blue'
-            estilo = '--' if variante == 'reciente' else '-'
-            marcador = 'o' if variante == 'reciente' else 's'
+            color, estilo, marcador = estilo_variante(variante)
             
             ax.plot(df['palabras'], df['nodos_normalizados'], 
                    color=color, linestyle=estilo, linewidth=2,
@@ -131,9 +140,7 @@ def graficar_tiempo_insercion_por_caracter(metricas_completas):
         variantes = metricas_completas[dataset]
         
         for variante, df in variantes.items():
-            color = 'red' if variante == 'reciente' else 'blue'
-            estilo = '--' if variante == 'reciente' else '-'
-            marcador = 'o' if variante == 'reciente' else 's'
+            color, estilo, marcador = estilo_variante(variante)
             
             ax.plot(df['palabras'], df['tiempo_por_caracter'], 
                    color=color, linestyle=estilo, linewidth=2,
@@ -169,9 +176,7 @@ def graficar_porcentaje_caracteres_escritos(metricas_completas):
         variantes = metricas_completas[dataset]
         
         for variante, df in variantes.items():
-            color = 'red' if variante == 'reciente' else 'blue'
-            estilo = '--' if variante == 'reciente' else '-'
-            marcador = 'o' if variante == 'reciente' else 's'
+            color, estilo, marcador = estilo_variante(variante)
             
             ax.plot(df['palabras'], df['porcentaje_caracteres'], 
                    color=color, linestyle=estilo, linewidth=2,
@@ -214,9 +219,7 @@ def graficar_todos_individualmente(metricas_completas):
             variantes = metricas_completas[dataset]
             
             for variante, df in variantes.items():
-                color = 'red' if variante == 'reciente' else 'blue'
-                estilo = '--' if variante == 'reciente' else '-'
-                marcador = 'o' if variante == 'reciente' else 's'
+                color, estilo, marcador = estilo_variante(variante)
                 
                 ax.plot(df['palabras'], df[metrica], 
                        color=color, linestyle=estilo, linewidth=2,
@@ -268,6 +271,62 @@ def generar_resumen_estadistico(metricas_completas):
             print(f"     • Tiempo por carácter final: {ultima_fila['tiempo_por_caracter']:.2f} μs")
             print(f"     • Tiempo total simulación: {ultima_fila['tiempo_acumulado_ms']/1000:.2f} segundos")
 
+def graficar_benchmarks():
+    """Compara las corridas de ./trie_bench (resultados/bench_<etiqueta>.csv)"""
+
+    archivos = sorted(glob.glob("resultados/bench_*.csv"), key=os.path.getmtime)
+    if not archivos:
+        return
+
+    corridas = []
+    for archivo in archivos:
+        df = pd.read_csv(archivo)
+        df['etiqueta'] = os.path.basename(archivo).replace('bench_', '').replace('.csv', '')
+        df['caso'] = df['escenario'] + '\n' + df['modo']
+        corridas.append(df)
+    datos = pd.concat(corridas, ignore_index=True)
+    # El reescalado de decaimiento dura ~1 ms y aplastaría las demás barras
+    datos = datos[datos['escenario'] != 'reescalado']
+    etiquetas = list(dict.fromkeys(datos['etiqueta']))   # de la más antigua a la más nueva
+    casos = list(dict.fromkeys(datos['caso']))
+
+    fig, axes = plt.subplots(2, 1, figsize=(16, 10))
+    ancho = 0.8 / len(etiquetas)
+    x = np.arange(len(casos))
+    for idx, etiqueta in enumerate(etiquetas):
+        df = datos[datos['etiqueta'] == etiqueta].set_index('caso').reindex(casos)
+        axes[0].bar(x + idx * ancho, df['ops_por_s'] / 1e6, ancho, label=etiqueta)
+        axes[1].bar(x + idx * ancho, df['p99_ns'], ancho, label=etiqueta)
+        axes[1].scatter(x + idx * ancho, df['p50_ns'], color='black', marker='_', s=200, zorder=3)
+
+    axes[0].set_ylabel('Millones de operaciones / s')
+    axes[0].set_title('Throughput por escenario')
+    axes[1].set_ylabel('Latencia (ns)')
+    axes[1].set_title('Latencia p99 por escenario (marca negra: p50)')
+    for ax in axes:
+        ax.set_xticks(x + ancho * (len(etiquetas) - 1) / 2)
+        ax.set_xticklabels(casos, fontsize=8)
+        ax.grid(True, alpha=0.3, axis='y')
+        ax.legend()
+
+    plt.suptitle('trie_bench: comparación entre corridas', fontsize=16, fontweight='bold')
+    plt.tight_layout()
+    plt.savefig('graficos_bench.png', dpi=300, bbox_inches='tight')
+    plt.show()
+
+    # Cambio de cada corrida contra la más antigua
+    if len(etiquetas) > 1:
+        base = datos[datos['etiqueta'] == etiquetas[0]].set_index('caso')
+        print(f"\nTRIE_BENCH: cambio contra '{etiquetas[0]}' (ops/s y p99)")
+        for etiqueta in etiquetas[1:]:
+            df = datos[datos['etiqueta'] == etiqueta].set_index('caso')
+            for caso in casos:
+                if caso not in df.index or caso not in base.index:
+                    continue
+                ops = 100.0 * (df.at[caso, 'ops_por_s'] / base.at[caso, 'ops_por_s'] - 1)
+                p99 = 100.0 * (df.at[caso, 'p99_ns'] / base.at[caso, 'p99_ns'] - 1)
+                print(f"   {etiqueta:>12} {caso.replace(chr(10), ' '):>28}: ops/s {ops:+6.1f}%  p99 {p99:+6.1f}%")
+
 def verificar_archivos_csv():
     """Verifica qué archivos CSV existen realmente"""
     print("🔍 VERIFICANDO ARCHIVOS CSV EXISTENTES:")
@@ -294,6 +353,9 @@ def main():
         return
     
     print("🚀 Cargando y procesando datos...")
+
+    # Corridas de ./trie_bench, si hay
+    graficar_benchmarks()
     
     # Primero verificar qué archivos existen
     archivos_existentes = verificar_archivos_csv()
@@ -340,6 +402,7 @@ def main():
     print("   - graficos_tiempo_por_caracter.png") 
     print("   - graficos_porcentaje_caracteres.png")
     print("   - graficos_individuales_[dataset].png (para cada dataset)")
+    print("   - graficos_bench.png (si hay resultados/bench_*.csv)")
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
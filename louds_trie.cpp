@@ -0,0 +1,256 @@
+#pragma once
+#include <iomanip>
+
+#include "trie.cpp"
+
+// Trie sucinto de solo lectura (LOUDS) para diccionarios que se cargan una
+// vez y se consultan muchas. Se arma desde un Trie ya construido y congela
+// sus mejores terminales; no admite insert() ni update_priority().
+//
+// Los nodos se numeran en orden BFS (la raíz es 0) y la forma del árbol es
+// un único vector de bits: "10" para una súper raíz y, por cada nodo en ese
+// orden, un 1 por hijo seguido de un 0. Los hijos de i empiezan en
+// select0(i) + 1 y el primero es el nodo select0(i) - i, así que bajar no
+// necesita punteros. Cada nodo guarda su letra en 5 bits.
+//
+// Mejor terminal: casi siempre es el mismo que el del padre, así que solo
+// se marca (own_) el nodo donde cambia y se guarda la palabra nueva en un
+// arreglo empaquetado indexado por rank1(own_, nodo). Position arrastra el
+// mejor del camino mientras se desciende.
+
+// Vector de bits con rank1 en O(1) (conteo cada 512 bits) y select0 con
+// muestras cada 256 ceros
+struct BitVector {
+    static const size_t BLOCK_WORDS = 8;      // 512 bits por bloque de rank
+    static const size_t ZERO_SAMPLE = 256;
+
+    std::vector<uint64_t> bits_;
+    std::vector<uint32_t> ranks_;             // unos antes de cada bloque
+    std::vector<uint32_t> zero_samples_;      // palabra del cero k * ZERO_SAMPLE
+    size_t size_ = 0;
+
+    void push_back(bool b) {
+        if ((size_ & 63) == 0) bits_.push_back(0);
+        if (b) bits_.back() |= 1ull << (size_ & 63);
+        ++size_;
+    }
+
+    bool operator[](size_t p) const { return (bits_[p >> 6] >> (p & 63)) & 1; }
+
+    // Arma los directorios; se llama una vez después del último push_back
+    void build() {
+        ranks_.clear();
+        zero_samples_.clear();
+        uint32_t ones = 0;
+        size_t zeros = 0;
+        for (size_t w = 0; w < bits_.size(); ++w) {
+            if (w % BLOCK_WORDS == 0) ranks_.push_back(ones);
+            size_t valid = std::min<size_t>(64, size_ - w * 64);
+            uint64_t word = bits_[w];
+            size_t z = valid - __builtin_popcountll(word);
+            // Muestra para cada múltiplo de ZERO_SAMPLE que cae en esta palabra
+            while (zero_samples_.size() * ZERO_SAMPLE < zeros + z) {
+                zero_samples_.push_back(static_cast<uint32_t>(w));
+            }
+            ones += __builtin_popcountll(word);
+            zeros += z;
+        }
+        bits_.shrink_to_fit();
+    }
+
+    // Unos en [0, p)
+    size_t rank1(size_t p) const {
+        size_t w = p >> 6;
+        size_t block = w / BLOCK_WORDS;
+        size_t r = ranks_[block];
+        for (size_t i = block * BLOCK_WORDS; i < w; ++i) r += __builtin_popcountll(bits_[i]);
+        if (p & 63) r += __builtin_popcountll(bits_[w] & ((1ull << (p & 63)) - 1));
+        return r;
+    }
+
+    // Posición del k-ésimo cero (desde 0)
+    size_t select0(size_t k) const {
+        size_t w = zero_samples_[k / ZERO_SAMPLE];
+        size_t before = w * 64 - rank1(w * 64);   // ceros antes de la palabra w
+        while (true) {
+            uint64_t z = ~bits_[w];
+            size_t n = __builtin_popcountll(z);
+            if (before + n > k) {
+                for (size_t j = before; j < k; ++j) z &= z - 1;
+                return w * 64 + __builtin_ctzll(z);
+            }
+            before += n;
+            ++w;
+        }
+    }
+
+    size_t memory_bytes() const {
+        return bits_.capacity() * sizeof(uint64_t) + ranks_.capacity() * sizeof(uint32_t) +
+               zero_samples_.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Enteros sin signo de `width` bits, uno tras otro
+struct PackedArray {
+    std::vector<uint64_t> words_;
+    uint32_t width_ = 0;
+    size_t size_ = 0;
+
+    explicit PackedArray(uint32_t width = 1) : width_(width) {}
+
+    void push_back(uint64_t v) {
+        size_t bit = size_ * width_;
+        words_.resize((bit + width_ + 63) / 64, 0);
+        words_[bit >> 6] |= v << (bit & 63);
+        if ((bit & 63) + width_ > 64) words_[(bit >> 6) + 1] |= v >> (64 - (bit & 63));
+        ++size_;
+    }
+
+    uint64_t operator[](size_t i) const {
+        size_t bit = i * width_;
+        size_t off = bit & 63;
+        uint64_t v = words_[bit >> 6] >> off;
+        if (off + width_ > 64) v |= words_[(bit >> 6) + 1] << (64 - off);
+        return v & ((1ull << width_) - 1);
+    }
+
+    size_t size() const { return size_; }
+    size_t memory_bytes() const { return words_.capacity() * sizeof(uint64_t); }
+};
+
+struct LoudsTrie {
+    typedef TrieTypes::Id Id;
+    static const Id NONE = TrieTypes::NONE;
+    static const uint32_t LABEL_BITS = 5;     // 27 letras ('a'..'z', '$')
+
+    // Nodo actual (número BFS) y mejor palabra del subárbol
+    struct Position {
+        Id node = NONE;
+        Id best = NONE;
+
+        explicit operator bool() const { return node != NONE; }
+    };
+
+    BitVector louds_;
+    PackedArray labels_{LABEL_BITS};    // letra de la arista que llega a cada nodo
+    BitVector own_;                     // el nodo tiene un mejor distinto al del padre
+    PackedArray best_;                  // palabra de cada nodo marcado en own_
+    std::string pool_;                  // letras de todas las palabras
+    std::vector<uint32_t> offsets_;     // palabra w = pool_[offsets_[w], offsets_[w+1])
+    size_t node_count_ = 0;
+
+    // Recorre el trie en BFS visitando los hijos en orden de letra
+    template <class TrieT>
+    explicit LoudsTrie(const TrieT& trie) {
+        static_assert(TrieT::ALPHABET_SIZE == 27, "LOUDS guarda etiquetas de 5 bits del alfabeto ASCII");
+        Id words = static_cast<Id>(trie.word_count());
+        uint32_t width = 1;
+        while ((1ull << width) <= words) ++width;   // words hace de "sin mejor"
+        best_ = PackedArray(width);
+
+        auto best_word = [&](const TrieTypes::Node* u) -> Id {
+            Id t = u->best_terminal();
+            return t == TrieTypes::NONE ? words : trie.node(t)->word;
+        };
+
+        louds_.push_back(1);
+        louds_.push_back(0);
+        labels_.push_back(0);
+        std::vector<std::pair<Id, Id>> queue = {{trie.root()->id, words + 1}};   // (nodo, mejor del padre)
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const TrieTypes::Node* u = trie.node(queue[head].first);
+            Id best = best_word(u);
+            own_.push_back(best != queue[head].second);
+            if (best != queue[head].second) best_.push_back(best);
+            for (int k = 0; k < 27; ++k) {
+                Id c = trie.child(u, k);
+                if (c == TrieTypes::NONE) continue;
+                louds_.push_back(1);
+                labels_.push_back(k);
+                queue.emplace_back(c, best);
+            }
+            louds_.push_back(0);
+        }
+        node_count_ = queue.size();
+        louds_.build();
+        own_.build();
+        labels_.words_.shrink_to_fit();
+        best_.words_.shrink_to_fit();
+
+        offsets_.reserve(words + 1);
+        for (Id w = 0; w < words; ++w) {
+            offsets_.push_back(static_cast<uint32_t>(pool_.size()));
+            pool_.append(trie.word_at(w));
+        }
+        offsets_.push_back(static_cast<uint32_t>(pool_.size()));
+        pool_.shrink_to_fit();
+    }
+
+    Position root() const { return Position{0, best_of(0, NONE)}; }
+
+    // Misma normalización que Trie::descend: la tabla del alfabeto ya
+    // acepta mayúsculas y '$'
+    Position descend(Position p, char c) const {
+        if (!p) return Position();
+        int k = alphabet_index<AsciiAlphabet>(c);
+        if (k < 0) return Position();
+
+        size_t start = louds_.select0(p.node) + 1;
+        Id child = static_cast<Id>(start - p.node - 1);
+        for (size_t b = start; louds_[b]; ++b, ++child) {
+            int label = static_cast<int>(labels_[child]);
+            if (label == k) return Position{child, best_of(child, p.best)};
+            if (label > k) break;   // hijos ordenados por letra
+        }
+        return Position();
+    }
+
+    // Mejor palabra con el prefijo de p (NONE si no hay)
+    Id autocomplete(Position p) const { return p ? p.best : NONE; }
+
+    // Palabra exacta de p (NONE si no está en el diccionario)
+    Id terminal(Position p) const {
+        Position t = descend(p, '$');
+        return t ? t.best : NONE;
+    }
+
+    std::string_view word(Id w) const {
+        return std::string_view(pool_.data() + offsets_[w], offsets_[w + 1] - offsets_[w]);
+    }
+
+    // --------------------------------------------------------
+    // Métricas
+    // --------------------------------------------------------
+    size_t node_count() const { return node_count_; }
+    size_t word_count() const { return offsets_.size() - 1; }
+
+    // Bytes de la forma del árbol y los mejores terminales, sin las palabras
+    size_t structure_bytes() const {
+        return louds_.memory_bytes() + labels_.memory_bytes() + own_.memory_bytes() + best_.memory_bytes();
+    }
+    size_t memory_bytes() const {
+        return structure_bytes() + pool_.capacity() + offsets_.capacity() * sizeof(uint32_t);
+    }
+
+    void print_stats() const {
+        std::cout << "=== Estadísticas del Trie LOUDS ===" << std::endl;
+        std::cout << "Nodos totales: " << node_count_ << std::endl;
+        std::cout << "Palabras almacenadas: " << word_count() << std::endl;
+        std::cout << "Bits LOUDS + rank/select: " << louds_.memory_bytes() << " bytes" << std::endl;
+        std::cout << "Etiquetas (" << LABEL_BITS << " bits): " << labels_.memory_bytes() << " bytes" << std::endl;
+        std::cout << "Mejores terminales: " << own_.memory_bytes() + best_.memory_bytes() << " bytes ("
+                  << best_.size() << " de " << best_.width_ << " bits)" << std::endl;
+        std::cout << "Bits por nodo (sin palabras): " << std::fixed << std::setprecision(2)
+                  << (8.0 * structure_bytes() / node_count_) << std::endl;
+        std::cout << "Memoria aproximada: " << memory_bytes() << " bytes" << std::endl;
+        std::cout << "===================================" << std::endl;
+    }
+
+private:
+
+    Id best_of(Id node, Id parent_best) const {
+        if (!own_[node]) return parent_best;
+        Id w = static_cast<Id>(best_[own_.rank1(node)]);
+        return w == word_count() ? NONE : w;
+    }
+};
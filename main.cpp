@@ -1,4 +1,5 @@
 #include "trie.cpp"
+#include "corpus.cpp"
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -8,64 +9,31 @@
 #include <cmath>
 #include <algorithm>
 
-// Función para cargar palabras desde un archivo .txt (una palabra por línea solo funcoina con words.txt)
-std::vector<std::string> load_words_from_file(const std::string& filename) {
-    std::vector<std::string> words;
-    std::ifstream file(filename);
-    std::string word;
-    
-    if (!file.is_open()) {
-        std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
-        return words;
-    }
-    
-    std::cout << "Cargando palabras desde " << filename << "..." << std::endl;
-    
-    int count = 0;
-    while (std::getline(file, word)) {
-        // Limpiar la palabra: convertir a minúsculas y mantener solo letras
-        std::string clean_word;
-        for (char c : word) {
-            if (std::isalpha((unsigned char)c)) {
-                clean_word.push_back(std::tolower((unsigned char)c));
-            }
-        }
-        
-        if (!clean_word.empty() && clean_word.length() > 1) {
-            words.push_back(clean_word);
-            count++;
-            
-            // Mostrar progreso cada 10000 palabras
-            if (count % 10000 == 0) {
-                std::cout << "Cargadas " << count << " palabras..." << std::endl;
-            }
-        }
-    }
-    
-    file.close();
-    std::cout << "Total de palabras cargadas: " << count << std::endl;
-    return words;
-}
-
 // info en terminal
 void show_usage() {
-    std::cout << "Uso: ./autocomplete <dataset.txt> <modo>\n";
+    std::cout << "Uso: ./autocomplete <dataset.txt|snapshot.trie> <modo>\n";
     std::cout << "  dataset.txt: archivo de texto con una palabra por línea\n";
+    std::cout << "  snapshot.trie: trie ya construido con ./snapshot (se mapea sin reconstruir)\n";
     std::cout << "  modo: 'reciente' o 'frecuente'\n";
     std::cout << "Ejemplos:\n";
     std::cout << "  ./autocomplete palabras.txt frecuente\n";
     std::cout << "  ./autocomplete english_words.txt reciente\n";
+    std::cout << "  ./autocomplete textos/words.trie frecuente\n";
 }
 
+// Cantidad de sugerencias que se muestran por prefijo
+const size_t MAX_SUGGESTIONS = 5;
+
 // Función para buscar autocompletado dado un prefijo
-void search_autocomplete(Trie& trie, const std::string& prefix) {
+template <class TrieT>
+void search_autocomplete(TrieT& trie, const std::string& prefix) {
     if (prefix.empty()) {
         std::cout << "Error: Prefijo vacío" << std::endl;
         return;
     }
     
     // Descender por el trie según el prefijo
-    Trie::Node* current = trie.root_;
+    TrieTypes::Node* current = trie.root_;
     for (char c : prefix) {
         current = trie.descend(current, c);
         if (!current) {
@@ -75,18 +43,29 @@ void search_autocomplete(Trie& trie, const std::string& prefix) {
     }
     
     // Obtener el mejor autocompletado
-    Trie::Node* best = trie.autocomplete(current);
-    if (best && best->str) {
-        std::cout << "Autocompletado: '" << *best->str << "'";
+    TrieTypes::Node* best = trie.autocomplete(current);
+    if (best && best->is_terminal()) {
+        std::cout << "Autocompletado: '" << trie.word(best) << "'";
         
         // Mostrar información adicional según el modo
-        if (trie.variant == Trie::Variant::MOST_RECENT) {
+        if (trie.variant == TrieTypes::Variant::MOST_RECENT) {
             std::cout << " (timestamp: " << best->priority << ")";
         } else {
             std::cout << " (frecuencia: " << best->priority << ")";
         }
         std::cout << std::endl;
         
+        // Lista de sugerencias como en un teclado
+        TrieTypes::Node* suggestions[MAX_SUGGESTIONS];
+        size_t n = trie.top_k(current, MAX_SUGGESTIONS, suggestions);
+        if (n > 1) {
+            std::cout << "Sugerencias:";
+            for (size_t i = 0; i < n; ++i) {
+                std::cout << (i ? ", " : " ") << trie.word(suggestions[i]);
+            }
+            std::cout << std::endl;
+        }
+        
         // Actualizar la prioridad de la palabra encontrada
         trie.update_priority(best);
     } else {
@@ -94,13 +73,53 @@ void search_autocomplete(Trie& trie, const std::string& prefix) {
     }
 }
 
+// Autocompleta de una vez todos los prefijos de un archivo (uno por línea)
+// con autocomplete_batch. Es solo lectura: no actualiza prioridades.
+template <class TrieT>
+void batch_autocomplete(TrieT& trie, const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) {
+        std::cout << "Error: No se pudo abrir el archivo " << filename << std::endl;
+        return;
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) lines.push_back(line);
+    }
+    std::vector<std::string_view> prefixes(lines.begin(), lines.end());
+    std::vector<TrieTypes::Node*> best(prefixes.size());
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    trie.autocomplete_batch(prefixes.data(), prefixes.size(), best.data());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    
+    size_t found = 0;
+    for (size_t i = 0; i < prefixes.size(); ++i) {
+        std::cout << prefixes[i] << " -> ";
+        if (best[i]) {
+            std::cout << trie.word(best[i]) << std::endl;
+            ++found;
+        } else {
+            std::cout << "(sin autocompletado)" << std::endl;
+        }
+    }
+    std::cout << found << "/" << prefixes.size() << " prefijos con autocompletado en " << std::fixed
+              << std::setprecision(3)
+              << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0
+              << " ms" << std::endl;
+}
+
 // Función principal de interacción
-void run_autocomplete(Trie& trie, const std::string& mode_name) {
+template <class TrieT>
+void run_autocomplete(TrieT& trie, const std::string& mode_name) {
     std::cout << "\n=== Motor de Autocompletado ===" << std::endl;
     std::cout << "Modo: " << mode_name << std::endl;
     std::cout << "Comandos:" << std::endl;
     std::cout << "  <prefijo>     - Buscar autocompletado para el prefijo" << std::endl;
     std::cout << "  !update <palabra> - Insertar/actualizar una palabra" << std::endl;
+    std::cout << "  !lote <archivo> - Autocompletar todos los prefijos del archivo (sin actualizar)" << std::endl;
     std::cout << "  !stats        - Mostrar estadísticas del trie" << std::endl;
     std::cout << "  !quit         - Salir del programa" << std::endl;
     std::cout << "================================\n" << std::endl;
@@ -110,6 +129,12 @@ void run_autocomplete(Trie& trie, const std::string& mode_name) {
         std::cout << "> ";
         std::getline(std::cin, input);
         
+        // El nombre de archivo de !lote se deja tal cual
+        if (input.find("!lote ") == 0) {
+            batch_autocomplete(trie, input.substr(6));
+            continue;
+        }
+        
         // Convertir a minúsculas para consistencia
         for (size_t i = 0; i < input.size(); ++i) {
             input[i] = std::tolower(static_cast<unsigned char>(input[i]));
@@ -126,7 +151,7 @@ void run_autocomplete(Trie& trie, const std::string& mode_name) {
             // Insertar o actualizar una palabra
             std::string word = input.substr(8);
             if (!word.empty()) {
-                Trie::Node* node = trie.insert(word);
+                TrieTypes::Node* node = trie.insert(word);
                 if (node) {
                     trie.update_priority(node);
                     std::cout << "Palabra '" << word << "' insertada/actualizada (" << mode_name << ")" << std::endl;
@@ -147,35 +172,17 @@ void run_autocomplete(Trie& trie, const std::string& mode_name) {
     }
 }
 
-int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        show_usage();
-        return 1;
-    }
-    
-    std::string filename = argv[1];
-    std::string mode_str = argv[2];
-    
-    // Validar modo
-    Trie::Variant variant;
-    if (mode_str == "reciente") {
-        variant = Trie::Variant::MOST_RECENT;
-    } else if (mode_str == "frecuente") {
-        variant = Trie::Variant::MOST_FREQUENT;
-    } else {
-        std::cerr << "Error: Modo debe ser 'reciente' o 'frecuente'" << std::endl;
-        show_usage();
-        return 1;
-    }
-    
+// Carga el corpus e inserta sus palabras con reporte de nodos cada 2^i
+template <class TrieT>
+bool build_from_corpus(TrieT& trie, const std::string& filename) {
     // Cargar palabras del dataset
     auto start_time = std::chrono::high_resolution_clock::now();
-    std::vector<std::string> words = load_words_from_file(filename);
+    Corpus words = load_corpus(filename, Corpus::Split::LINES, 2);
     auto end_time = std::chrono::high_resolution_clock::now();
     
     if (words.empty()) {
         std::cerr << "Error: No se pudieron cargar palabras del archivo" << std::endl;
-        return 1;
+        return false;
     }
     
     auto load_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -188,8 +195,6 @@ int main(int argc, char* argv[]) {
     
     start_time = std::chrono::high_resolution_clock::now();
     
-    Trie trie(variant);
-    
     // Potencias de 2 hasta 262144
     std::vector<size_t> milestones;
     for (int i = 0; i <= 18; ++i) { // 2^18 = 262144
@@ -233,13 +238,54 @@ int main(int argc, char* argv[]) {
     
     std::cout << "-----------------------------------" << std::endl;
     std::cout << "Trie construido en " << build_duration.count() << " ms" << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        show_usage();
+        return 1;
+    }
     
-    // Estadísticas finales
-    std::cout << "\n=== Estadísticas Finales ===" << std::endl;
-    trie.print_stats();
+    std::string filename = argv[1];
+    std::string mode_str = argv[2];
     
-    // Ejecutar la interfaz interactiva
-    run_autocomplete(trie, mode_str);
+    // Validar modo
+    TrieTypes::Variant variant;
+    if (mode_str == "reciente") {
+        variant = TrieTypes::Variant::MOST_RECENT;
+    } else if (mode_str == "frecuente") {
+        variant = TrieTypes::Variant::MOST_FREQUENT;
+    } else {
+        std::cerr << "Error: Modo debe ser 'reciente' o 'frecuente'" << std::endl;
+        show_usage();
+        return 1;
+    }
     
-    return 0;
+    return with_ranking(variant, [&](auto ranking) {
+        Trie<decltype(ranking)> trie(MAX_SUGGESTIONS);
+        if (trie.is_snapshot(filename)) {
+            // El snapshot se usa directo desde el mmap; el modo lo decide la línea de comandos
+            auto start_time = std::chrono::high_resolution_clock::now();
+            if (!trie.open(filename)) {
+                std::cerr << "Error: No se pudo abrir el snapshot " << filename << std::endl;
+                return 1;
+            }
+            auto end_time = std::chrono::high_resolution_clock::now();
+            std::cout << "Snapshot abierto en " << std::fixed << std::setprecision(2)
+                      << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0
+                      << " ms" << std::endl;
+        } else if (!build_from_corpus(trie, filename)) {
+            return 1;
+        }
+        
+        // Estadísticas finales
+        std::cout << "\n=== Estadísticas Finales ===" << std::endl;
+        trie.print_stats();
+        
+        // Ejecutar la interfaz interactiva
+        run_autocomplete(trie, mode_str);
+        
+        return 0;
+    });
 }
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "trie.cpp"
+#include "corpus.cpp"
+#include "epoch.cpp"
+#include "thread_pool.cpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Benchmarks de concurrencia:
+// 1) Lectura: R hilos lectores piden autocompletado para prefijos al azar
+//    sin locks mientras un escritor aplica insert() + update_priority() a
+//    tasa fija. La mitad del dataset se inserta antes de empezar; la otra
+//    mitad la inserta el escritor, así que también hay cambios de estructura
+//    (nodos nuevos y bloques que crecen) durante la medición.
+// 2) Escritura: W hilos llaman update_priority_shared() con palabras
+//    elegidas según una Zipf, y el resultado se compara contra aplicar la
+//    misma secuencia con update_priority() en un solo hilo.
+
+struct StressResult {
+    size_t reads = 0;
+    size_t updates = 0;
+    size_t errors = 0;     // sugerencias que no son terminales del subárbol
+    double seconds = 0;
+    uint64_t epochs = 0;
+};
+
+// xorshift para elegir prefijos sin compartir estado entre hilos
+static inline uint64_t next_random(uint64_t& x) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+template <class Ranking>
+StressResult run_stress(const Corpus& words, size_t readers, double update_rate, double seconds) {
+    EpochManager epoch;
+    Trie<Ranking> trie;
+    size_t preload = words.size() / 2;
+    for (size_t i = 0; i < preload; ++i) trie.insert(words[i]);
+    trie.enable_concurrent_reads(&epoch);
+
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> ready{0};
+    std::vector<size_t> reads(readers, 0), errors(readers, 0);
+    StressResult result;
+
+    // Escritor: lotes cada 1 ms para sostener update_rate por segundo
+    std::thread writer([&]() {
+        while (ready.load() < readers) std::this_thread::yield();
+        const size_t per_tick = std::max<size_t>(1, static_cast<size_t>(update_rate / 1000));
+        auto tick = std::chrono::steady_clock::now();
+        size_t next = preload;
+        while (!stop.load(std::memory_order_relaxed)) {
+            for (size_t j = 0; j < per_tick; ++j) {
+                TrieTypes::Node* t = trie.insert(words[next]);
+                if (t) trie.update_priority(t);
+                if (++next == words.size()) next = 0;
+                ++result.updates;
+            }
+            epoch.collect();
+            tick += std::chrono::milliseconds(1);
+            std::this_thread::sleep_until(tick);
+        }
+    });
+
+    std::vector<std::thread> pool;
+    for (size_t r = 0; r < readers; ++r) {
+        pool.emplace_back([&, r]() {
+            int slot = epoch.register_reader();
+            uint64_t rng = 0x9E3779B97F4A7C15ull * (r + 1);
+            size_t done = 0, bad = 0;
+            ready.fetch_add(1);
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::string_view w = words[next_random(rng) % words.size()];
+                size_t len = 1 + next_random(rng) % w.size();
+
+                EpochManager::Guard guard(epoch, slot);
+                TrieTypes::Node* v = trie.root();
+                for (size_t i = 0; i < len && v; ++i) v = trie.descend_shared(v, w[i]);
+                TrieTypes::Node* best = trie.autocomplete_shared(v);
+                if (best) {
+                    // La sugerencia tiene que ser un terminal dentro del subárbol de v
+                    bool ok = load_shared(best->word) != TrieTypes::NONE;
+                    if (ok && (done & 63) == 0) {
+                        const TrieTypes::Node* a = best;
+                        while (a && a != v) a = trie.node_shared(a->parent);
+                        ok = (a == v);
+                    }
+                    if (!ok) ++bad;
+                }
+                ++done;
+            }
+            reads[r] = done;
+            errors[r] = bad;
+            epoch.unregister_reader(slot);
+        });
+    }
+
+    while (ready.load() < readers) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (std::thread& t : pool) t.join();
+    writer.join();
+    auto end = std::chrono::steady_clock::now();
+
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    for (size_t r = 0; r < readers; ++r) {
+        result.reads += reads[r];
+        result.errors += errors[r];
+    }
+    result.epochs = epoch.epoch();
+    epoch.drain();
+    return result;
+}
+
+// Zipf(s) sobre n rangos: tabla acumulada y búsqueda binaria
+struct ZipfSampler {
+    std::vector<double> cdf;
+
+    ZipfSampler(size_t n, double s) : cdf(n) {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) cdf[i] = (sum += 1.0 / std::pow(i + 1.0, s));
+        for (double& c : cdf) c /= sum;
+    }
+
+    size_t operator()(uint64_t& rng) const {
+        double u = (next_random(rng) >> 11) * (1.0 / 9007199254740992.0);
+        return std::min<size_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin(), cdf.size() - 1);
+    }
+};
+
+// Inserta todas las palabras en orden; retorna los terminales nuevos
+template <class TrieT>
+std::vector<TrieTypes::Id> build_all(TrieT& trie, const Corpus& words) {
+    std::vector<TrieTypes::Id> terminals;
+    for (size_t i = 0; i < words.size(); ++i) {
+        size_t before = trie.word_count();
+        TrieTypes::Node* t = trie.insert(words[i]);
+        if (trie.word_count() != before) terminals.push_back(t->id);
+    }
+    return terminals;
+}
+
+// Nodos cuyo mejor no es el máximo de su subárbol. Los hijos siempre tienen
+// índice mayor que el padre, así que basta recorrer los índices al revés.
+template <class TrieT>
+size_t check_best_invariant(const TrieT& trie) {
+    size_t n = trie.node_count();
+    std::vector<int64_t> max_priority(n, std::numeric_limits<int64_t>::min());
+    size_t errors = 0;
+    for (size_t i = n; i-- > 0;) {
+        const TrieTypes::Node* u = trie.node(static_cast<TrieTypes::Id>(i));
+        if (u->is_terminal()) max_priority[i] = std::max(max_priority[i], u->priority);
+        const TrieTypes::Node* best = trie.node(u->best_terminal());
+        if (u->best_priority() != max_priority[i] || (best && best->priority != max_priority[i])) ++errors;
+        if (u->parent != TrieTypes::NONE)
+            max_priority[u->parent] = std::max(max_priority[u->parent], max_priority[i]);
+    }
+    return errors;
+}
+
+template <class Ranking>
+void run_writers(const Corpus& words, size_t max_writers, size_t updates) {
+    // Secuencia Zipf fija sobre las palabras distintas (rango al azar)
+    Trie<Ranking> sequential;
+    std::vector<TrieTypes::Id> terminals = build_all(sequential, words);
+    std::shuffle(terminals.begin(), terminals.end(), std::mt19937_64(42));
+    ZipfSampler zipf(terminals.size(), 1.0);
+    std::vector<TrieTypes::Id> ops(updates);
+    uint64_t rng = 0x2545F4914F6CDD1Dull;
+    for (TrieTypes::Id& op : ops) op = terminals[zipf(rng)];
+
+    auto start = std::chrono::steady_clock::now();
+    for (TrieTypes::Id op : ops) sequential.update_priority(sequential.node(op));
+    double sequential_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool replay = (Ranking::VARIANT == TrieTypes::Variant::MOST_FREQUENT);
+    std::cout << "\n=== Escritores concurrentes: " << updates << " updates Zipf(1.0) sobre "
+              << terminals.size() << " palabras ===" << std::endl;
+    std::cout << "Secuencial (update_priority): " << std::fixed << std::setprecision(2)
+              << updates / sequential_s / 1e6 << " M updates/s" << std::endl;
+    std::cout << std::setw(10) << "Escritores" << " | " << std::setw(12) << "M updates/s" << " | "
+              << std::setw(8) << "Speedup" << " | " << std::setw(10) << "Invariante" << " | "
+              << std::setw(10) << "Distintos" << " | " << "Empates" << std::endl;
+
+    for (size_t w = 1; w <= max_writers; ++w) {
+        Trie<Ranking> trie;
+        build_all(trie, words);
+
+        std::vector<std::thread> pool;
+        start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < w; ++t) {
+            pool.emplace_back([&, t]() {
+                size_t from = ops.size() * t / w, to = ops.size() * (t + 1) / w;
+                for (size_t i = from; i < to; ++i) trie.update_priority_shared(trie.node(ops[i]));
+            });
+        }
+        for (std::thread& th : pool) th.join();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Contra la repetición secuencial (en FRECUENTE el orden no cambia las
+        // prioridades finales): mismo mejor valor por nodo; si cambia el
+        // terminal tiene que ser un empate
+        size_t different = 0, ties = 0;
+        if (replay) {
+            for (TrieTypes::Id i = 0; i < trie.node_count(); ++i) {
+                const TrieTypes::Node* a = trie.node(i);
+                const TrieTypes::Node* b = sequential.node(i);
+                if (a->priority != b->priority || a->best_priority() != b->best_priority()) {
+                    ++different;
+                } else if (a->best_terminal() != b->best_terminal()) {
+                    ++ties;
+                }
+            }
+        }
+        std::cout << std::setw(10) << w << " | " << std::setw(12) << std::setprecision(2) << updates / s / 1e6
+                  << " | " << std::setw(8) << sequential_s / s << " | " << std::setw(10) << check_best_invariant(trie)
+                  << " | " << std::setw(10) << (replay ? std::to_string(different) : "-")
+                  << " | " << (replay ? std::to_string(ties) : "-") << std::endl;
+    }
+    if (!replay) {
+        std::cout << "(en RECIENTE el resultado depende del orden entre hilos: solo se verifica la invariante)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 6) {
+        std::cout << "Uso: ./concurrencia <dataset.txt> <modo> [max_hilos] [updates_por_segundo] [segundos]\n";
+        std::cout << "  modo: 'reciente' o 'frecuente'\n";
+        std::cout << "  max_hilos: mide con 1..max_hilos lectores y luego escritores (por defecto, los núcleos)\n";
+        std::cout << "  updates_por_segundo: tasa fija del escritor (por defecto 100000)\n";
+        std::cout << "  segundos: duración de cada medición (por defecto 1)\n";
+        return 1;
+    }
+
+    std::string filename = argv[1];
+    std::string mode_str = argv[2];
+    size_t max_readers = (argc > 3) ? std::stoul(argv[3]) : default_thread_count(EpochManager::MAX_READERS);
+    double update_rate = (argc > 4) ? std::stod(argv[4]) : 100000;
+    double seconds = (argc > 5) ? std::stod(argv[5]) : 1.0;
+    max_readers = std::min<size_t>(std::max<size_t>(max_readers, 1), EpochManager::MAX_READERS);
+
+    TrieTypes::Variant variant;
+    if (mode_str == "reciente") {
+        variant = TrieTypes::Variant::MOST_RECENT;
+    } else if (mode_str == "frecuente") {
+        variant = TrieTypes::Variant::MOST_FREQUENT;
+    } else {
+        std::cerr << "Error: Modo debe ser 'reciente' o 'frecuente'" << std::endl;
+        return 1;
+    }
+
+    Corpus words = load_corpus(filename, Corpus::Split::WHITESPACE);
+    if (words.size() < 2) {
+        std::cerr << "Error: No se pudieron cargar palabras" << std::endl;
+        return 1;
+    }
+
+    std::cout << "\n=== Lectores concurrentes con un escritor a " << update_rate << " updates/s ===" << std::endl;
+    std::cout << std::setw(9) << "Lectores" << " | " << std::setw(14) << "Consultas/s" << " | "
+              << std::setw(14) << "Por lector" << " | " << std::setw(11) << "Updates/s" << " | "
+              << std::setw(7) << "Épocas" << " | " << "Errores" << std::endl;
+    for (size_t r = 1; r <= max_readers; ++r) {
+        StressResult res = with_ranking(variant, [&](auto ranking) {
+            return run_stress<decltype(ranking)>(words, r, update_rate, seconds);
+        });
+        double qps = res.reads / res.seconds;
+        std::cout << std::setw(9) << r << " | " << std::setw(14) << std::fixed << std::setprecision(0) << qps
+                  << " | " << std::setw(14) << qps / r << " | " << std::setw(11) << res.updates / res.seconds
+                  << " | " << std::setw(7) << res.epochs << " | " << res.errors << std::endl;
+    }
+
+    const size_t WRITER_UPDATES = 2000000;
+    // update_priority_shared solo existe para los rankings con bump_shared
+    if (variant == TrieTypes::Variant::MOST_RECENT) {
+        run_writers<RecentRanking>(words, max_readers, WRITER_UPDATES);
+    } else {
+        run_writers<FrequentRanking>(words, max_readers, WRITER_UPDATES);
+    }
+    return 0;
+}
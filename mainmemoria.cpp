@@ -1,4 +1,9 @@
 #include "trie.cpp"
+#include "corpus.cpp"
+#include "radix_trie.cpp"
+#include "louds_trie.cpp"
+#include "memory_stats.cpp"
+#include "alloc_tracking.cpp"
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -6,65 +11,203 @@
 #include <iomanip>
 #include <functional> 
 #include <cmath>      
-
-// Función para cargar palabras desde un archivo .txt (una palabra por línea solo funciona con words.txt)
-std::vector<std::string> load_words_from_file(const std::string& filename) {
-    std::vector<std::string> words;
-    std::ifstream file(filename);
-    std::string word;
-    
-    if (!file.is_open()) {
-        std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
-        return words;
-    }
-    
-    std::cout << "Cargando palabras desde " << filename << "..." << std::endl;
-    
-    int count = 0;
-    while (std::getline(file, word)) {
-        // Limpiar la palabra
-        std::string clean_word;
-        for (char c : word) {
-            if (std::isalpha((unsigned char)c)) {
-                clean_word.push_back(std::tolower((unsigned char)c));
-            }
-        }
-        
-        if (!clean_word.empty() && clean_word.length() > 1) {
-            words.push_back(clean_word);
-            count++;
-            
-            // Mostrar progreso cada 10000 palabras, cambiar el numero despues de % para reducir info en terminal
-            if (count % 10000 == 0) {
-                std::cout << "Cargadas " << count << " palabras..." << std::endl;
-            }
-        }
-    }
-    
-    file.close();
-    std::cout << "Total de palabras cargadas: " << count << std::endl;
-    return words;
-}
+#include <deque>
 
 // info en pantalla
 void show_usage() {
-    std::cout << "Uso: ./autocomplete <dataset.txt> <modo>\n";
+    std::cout << "Uso: ./memoria <dataset.txt> <modo> [radix]\n";
     std::cout << "  dataset.txt: archivo de texto con una palabra por línea\n";
     std::cout << "  modo: 'reciente' o 'frecuente'\n";
+    std::cout << "  radix: además construye un RadixTrie y compara la cantidad de nodos\n";
     std::cout << "Ejemplos:\n";
-    std::cout << "  ./autocomplete palabras.txt frecuente\n";
-    std::cout << "  ./autocomplete english_words.txt reciente\n";
+    std::cout << "  ./memoria palabras.txt frecuente\n";
+    std::cout << "  ./memoria english_words.txt reciente radix\n";
+}
+
+// Histograma de tipos de nodo y memoria por palabra (arreglo fijo vs adaptativo)
+template <class TrieT>
+void print_node_kinds(const TrieT& trie) {
+    static const char* names[TrieTypes::NUM_KINDS] = {"N0 (hoja)", "N1", "N4", "N16", "N27"};
+    const auto& hist = trie.kind_histogram();
+
+    std::cout << "\n=== Tipos de nodo ===" << std::endl;
+    for (int k = 0; k < TrieTypes::NUM_KINDS; ++k) {
+        std::cout << std::setw(10) << names[k] << ": " << std::setw(8) << hist[k]
+                  << " (" << std::fixed << std::setprecision(2)
+                  << (100.0 * hist[k] / trie.node_count()) << "%)" << std::endl;
+    }
+
+    size_t words = trie.word_count();
+    if (words == 0) return;
+    size_t before = trie.fixed_layout_memory_bytes();
+    size_t after = trie.approx_memory_bytes();
+    std::cout << "Bytes por palabra (arreglo fijo de 27): " << std::fixed << std::setprecision(2)
+              << (static_cast<double>(before) / words) << std::endl;
+    std::cout << "Bytes por palabra (nodos adaptativos):  " << std::fixed << std::setprecision(2)
+              << (static_cast<double>(after) / words) << std::endl;
+    std::cout << "Reducción: " << std::fixed << std::setprecision(2)
+              << (100.0 * (before - after) / before) << "%" << std::endl;
+}
+
+// Congela el trie en LOUDS y compara bytes por palabra contra los nodos con
+// índices; "estructura" deja fuera las letras de las palabras y el top-k
+template <class TrieT>
+void compare_with_louds(const TrieT& trie) {
+    size_t words = trie.word_count();
+    if (words == 0) return;
+    LoudsTrie louds(trie);
+
+    size_t trie_total = trie.approx_memory_bytes();
+    size_t trie_structure = trie_total - trie.word_bytes() - trie.topk_bytes();
+    std::cout << "\n=== Trie vs LOUDS (solo lectura) ===" << std::endl;
+    std::cout << std::setw(10) << "" << " | " << std::setw(14) << "Bytes/palabra" << " | "
+              << std::setw(20) << "Estructura B/palabra" << " | " << std::setw(10) << "Bits/nodo" << std::endl;
+    std::cout << "----------------------------------------------------------------" << std::endl;
+    auto row = [&](const char* name, size_t total, size_t structure) {
+        std::cout << std::setw(10) << name << " | " << std::setw(14) << std::fixed << std::setprecision(2)
+                  << (static_cast<double>(total) / words) << " | " << std::setw(20)
+                  << (static_cast<double>(structure) / words) << " | " << std::setw(10)
+                  << (8.0 * structure / trie.node_count()) << std::endl;
+    };
+    row("Trie", trie_total, trie_structure);
+    row("LOUDS", louds.memory_bytes(), louds.structure_bytes());
+    louds.print_stats();
+}
+
+// Guarda las palabras del trie como antes (un std::string por palabra en un
+// deque) y en el WordPool actual; compara bytes de heap por palabra
+// (alloc_tracking.cpp) y tiempo por palabra agregada (mejor de 5 pasadas)
+template <class TrieT>
+void compare_word_storage(const TrieT& trie) {
+    size_t words = trie.word_count();
+    if (words == 0) return;
+    const int reps = 5;
+
+    auto measure = [&](auto&& store) {
+        double best_ns = 0;
+        size_t bytes = 0;
+        for (int r = 0; r < reps; ++r) {
+            int64_t before = alloc_snapshot().total_bytes();
+            auto start = std::chrono::high_resolution_clock::now();
+            auto container = store();
+            auto end = std::chrono::high_resolution_clock::now();
+            bytes = static_cast<size_t>(alloc_snapshot().total_bytes() - before);
+            double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            if (r == 0 || ns < best_ns) best_ns = ns;
+        }
+        return std::make_pair(bytes, best_ns);
+    };
+    auto with_deque = measure([&] {
+        auto d = std::make_unique<std::deque<std::string>>();
+        for (TrieTypes::Id w = 0; w < words; ++w) d->emplace_back(trie.word_at(w));
+        return d;
+    });
+    auto with_pool = measure([&] {
+        auto p = std::make_unique<WordPool>();
+        for (TrieTypes::Id w = 0; w < words; ++w) p->append(trie.word_at(w));
+        return p;
+    });
+
+    std::cout << "\n=== Palabras: deque<std::string> vs WordPool ===" << std::endl;
+    std::cout << std::setw(14) << "" << " | " << std::setw(14) << "Bytes/palabra" << " | " << std::setw(10)
+              << "ns/palabra" << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    auto row = [&](const char* name, std::pair<size_t, double> m) {
+        std::cout << std::setw(14) << name << " | " << std::setw(14) << std::fixed << std::setprecision(2)
+                  << static_cast<double>(m.first) / words << " | " << std::setw(10) << m.second / words << std::endl;
+    };
+    row("deque<string>", with_deque);
+    row("WordPool", with_pool);
+    std::cout << "Letras por palabra: " << std::fixed << std::setprecision(2)
+              << static_cast<double>(trie.words_.chars_bytes()) / words
+              << ", en el trie: " << static_cast<double>(trie.word_bytes()) / words << " bytes/palabra" << std::endl;
+}
+
+// Memoria medida al llegar a un milestone
+struct MemorySample {
+    size_t words;
+    AllocSnapshot allocs;
+    size_t rss_kb;
+};
+
+// Bytes vivos por categoría (alloc_tracking.cpp) junto al RSS muestreado en
+// cada milestone, y asignaciones por palabra insertada desde `start`
+void print_memory_samples(const std::vector<MemorySample>& samples, const AllocSnapshot& start) {
+    const size_t tags = static_cast<size_t>(MemTag::COUNT);
+    std::cout << "\n=== Memoria medida por milestone (heap por categoría, KB) ===" << std::endl;
+    std::cout << std::setw(8) << "Palabras";
+    for (size_t t = 0; t < tags; ++t) std::cout << " | " << std::setw(8) << mem_tag_name(static_cast<MemTag>(t));
+    std::cout << " | " << std::setw(8) << "Total" << " | " << std::setw(8) << "RSS" << " | " << std::setw(11)
+              << "Asig/palabra" << std::endl;
+    std::cout << std::string(8 + 11 * (tags + 2) + 14, '-') << std::endl;
+    for (const MemorySample& s : samples) {
+        std::cout << std::setw(8) << s.words;
+        for (size_t t = 0; t < tags; ++t) std::cout << " | " << std::setw(8) << s.allocs.live_bytes[t] / 1024;
+        std::cout << " | " << std::setw(8) << s.allocs.total_bytes() / 1024 << " | " << std::setw(8) << s.rss_kb
+                  << " | " << std::setw(11) << std::fixed << std::setprecision(4)
+                  << static_cast<double>(s.allocs.allocations() - start.allocations()) / s.words << std::endl;
+    }
+}
+
+// Lo que estima approx_memory_bytes() contra lo que el trie tiene asignado
+template <class TrieT>
+void print_measured_vs_approx(const TrieT& trie, const AllocSnapshot& now) {
+    int64_t measured = now.bytes(MemTag::NODES) + now.bytes(MemTag::CHILDREN) + now.bytes(MemTag::WORDS) +
+                       now.bytes(MemTag::TOPK);
+    size_t approx = trie.approx_memory_bytes();
+    std::cout << "approx_memory_bytes(): " << approx / 1024 << " KB, medido (nodos + hijos + palabras + top-k): "
+              << measured / 1024 << " KB (" << std::fixed << std::setprecision(2)
+              << (100.0 * (measured - static_cast<int64_t>(approx)) / approx) << "% más)" << std::endl;
+}
+
+// Construye un RadixTrie con las mismas palabras y compara la cantidad de
+// nodos contra el trie normal en cada milestone
+void compare_with_radix(const Corpus& words, TrieTypes::Variant variant,
+                        const std::vector<size_t>& milestones,
+                        const std::vector<size_t>& trie_nodes) {
+    std::cout << "\n=== Trie vs Radix ===" << std::endl;
+    std::cout << std::setw(8) << "Palabras" << " | "
+              << std::setw(10) << "Nodos trie" << " | "
+              << std::setw(11) << "Nodos radix" << " | "
+              << std::setw(11) << "Radix/Trie" << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+
+    RadixTrie radix(variant);
+    size_t next_milestone_idx = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < words.size(); ++i) {
+        radix.insert(words[i]);
+        if (next_milestone_idx < trie_nodes.size() &&
+            (i + 1) == milestones[next_milestone_idx]) {
+            size_t radix_nodes = radix.node_count();
+            std::cout << std::setw(8) << (i + 1) << " | "
+                      << std::setw(10) << trie_nodes[next_milestone_idx] << " | "
+                      << std::setw(11) << radix_nodes << " | "
+                      << std::setw(11) << std::fixed << std::setprecision(4)
+                      << (static_cast<double>(radix_nodes) / trie_nodes[next_milestone_idx])
+                      << std::endl;
+            next_milestone_idx++;
+        }
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Radix construido en "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()
+              << " ms" << std::endl;
+    radix.print_stats();
 }
 
 // Función para buscar autocompletado dado un prefijo
-void search_autocomplete(Trie& trie, const std::string& prefix) {
+template <class TrieT>
+void search_autocomplete(TrieT& trie, const std::string& prefix) {
     if (prefix.empty()) {
         std::cout << "Error: Prefijo vacío" << std::endl;
         return;
     }
     
     // Descender por el trie según el prefijo
-    Trie::Node* current = trie.root_;
+    TrieTypes::Node* current = trie.root_;
     for (char c : prefix) {
         current = trie.descend(current, c);
         if (!current) {
@@ -74,12 +217,12 @@ void search_autocomplete(Trie& trie, const std::string& prefix) {
     }
     
     // Obtener el mejor autocompletado
-    Trie::Node* best = trie.autocomplete(current);
-    if (best && best->str) {
-        std::cout << "Autocompletado: '" << *best->str << "'";
+    TrieTypes::Node* best = trie.autocomplete(current);
+    if (best && best->is_terminal()) {
+        std::cout << "Autocompletado: '" << trie.word(best) << "'";
         
         // Mostrar información adicional según el modo
-        if (trie.variant == Trie::Variant::MOST_RECENT) {
+        if (trie.variant == TrieTypes::Variant::MOST_RECENT) {
             std::cout << " (timestamp: " << best->priority << ")";
         } else {
             std::cout << " (frecuencia: " << best->priority << ")";
@@ -94,7 +237,8 @@ void search_autocomplete(Trie& trie, const std::string& prefix) {
 }
 
 // Función principal
-void run_autocomplete(Trie& trie, const std::string& mode_name) {
+template <class TrieT>
+void run_autocomplete(TrieT& trie, const std::string& mode_name) {
     std::cout << "\n=== Motor de Autocompletado ===" << std::endl;
     std::cout << "Modo: " << mode_name << std::endl;
     std::cout << "Comandos:" << std::endl;
@@ -133,20 +277,21 @@ void run_autocomplete(Trie& trie, const std::string& mode_name) {
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
+    if (argc != 3 && argc != 4) {
         show_usage();
         return 1;
     }
     
     std::string filename = argv[1];
     std::string mode_str = argv[2];
+    bool compare_radix = (argc == 4 && std::string(argv[3]) == "radix");
     
     // Validar modo
-    Trie::Variant variant;
+    TrieTypes::Variant variant;
     if (mode_str == "reciente") {
-        variant = Trie::Variant::MOST_RECENT;
+        variant = TrieTypes::Variant::MOST_RECENT;
     } else if (mode_str == "frecuente") {
-        variant = Trie::Variant::MOST_FREQUENT;
+        variant = TrieTypes::Variant::MOST_FREQUENT;
     } else {
         std::cerr << "Error: Modo debe ser 'reciente' o 'frecuente'" << std::endl;
         show_usage();
@@ -155,7 +300,7 @@ int main(int argc, char* argv[]) {
     
     // Cargar palabras del dataset
     auto start_time = std::chrono::high_resolution_clock::now();
-    std::vector<std::string> words = load_words_from_file(filename);
+    Corpus words = load_corpus(filename, Corpus::Split::LINES, 2);
     auto end_time = std::chrono::high_resolution_clock::now();
     
     if (words.empty()) {
@@ -165,6 +310,10 @@ int main(int argc, char* argv[]) {
     
     auto load_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     std::cout << "Tiempo de carga: " << load_duration.count() << " ms" << std::endl;
+    AllocSnapshot loaded = alloc_snapshot();
+    std::cout << "Carga: " << loaded.bytes(MemTag::LOADER) / 1024 << " KB de heap en "
+              << loaded.live_count[static_cast<size_t>(MemTag::LOADER)] << " asignaciones + "
+              << words.mapped_bytes() / 1024 << " KB mapeados del archivo" << std::endl;
     
     // Crear el trie y insertar palabras con reporte de nodos cada 2^i palabras
     std::cout << "\nConstruyendo trie..." << std::endl;
@@ -177,70 +326,88 @@ int main(int argc, char* argv[]) {
               << std::setw(10) << "Compresión" << std::endl;
     std::cout << "--------------------------------------------" << std::endl;
     
-    start_time = std::chrono::high_resolution_clock::now();
+    return with_ranking(variant, [&](auto ranking) {
+        start_time = std::chrono::high_resolution_clock::now();
     
-    Trie trie(variant);
+        Trie<decltype(ranking)> trie;
     
-    // Potencias de 2 hasta 262144
-    std::vector<size_t> milestones;
-    for (int i = 0; i <= 18; ++i) { // 2^18 = 262144
-        size_t milestone = static_cast<size_t>(std::pow(2, i));
-        if (milestone <= words.size()) {
-            milestones.push_back(milestone);
+        // Potencias de 2 hasta 262144
+        std::vector<size_t> milestones;
+        for (int i = 0; i <= 18; ++i) { // 2^18 = 262144
+            size_t milestone = static_cast<size_t>(std::pow(2, i));
+            if (milestone <= words.size()) {
+                milestones.push_back(milestone);
+            }
         }
-    }
     
-    // Si hay menos de 262144 palabras
-    if (words.size() < 262144) {
-        milestones.push_back(words.size());
-    }
+        // Si hay menos de 262144 palabras
+        if (words.size() < 262144) {
+            milestones.push_back(words.size());
+        }
     
-    size_t next_milestone_idx = 0;
+        size_t next_milestone_idx = 0;
+        std::vector<size_t> nodes_at_milestone;
+        std::vector<MemorySample> memory_samples;
+        AllocSnapshot build_start = alloc_snapshot();
     
-    // Insertar todas las palabras en el trie
-    for (size_t i = 0; i < words.size(); ++i) {
-        size_t chars_before = trie.total_chars();
-        trie.insert(words[i]);
-        size_t chars_after = trie.total_chars();
-        size_t chars_in_word = chars_after - chars_before;
+        // Insertar todas las palabras en el trie
+        for (size_t i = 0; i < words.size(); ++i) {
+            size_t chars_before = trie.total_chars();
+            trie.insert(words[i]);
+            size_t chars_after = trie.total_chars();
+            size_t chars_in_word = chars_after - chars_before;
         
-        // Verificar si alcanzamos un milestone de potencia de 2
-        if (next_milestone_idx < milestones.size() && 
-            (i + 1) == milestones[next_milestone_idx]) {
-            size_t current_words = i + 1;
-            size_t current_nodes = trie.node_count();
-            size_t total_chars = trie.total_chars();
+            // Verificar si alcanzamos un milestone de potencia de 2
+            if (next_milestone_idx < milestones.size() && 
+                (i + 1) == milestones[next_milestone_idx]) {
+                size_t current_words = i + 1;
+                size_t current_nodes = trie.node_count();
+                size_t total_chars = trie.total_chars();
             
-            double nodes_per_char = static_cast<double>(current_nodes) / total_chars;
-            double compression_ratio = static_cast<double>(total_chars) / current_nodes;
+                nodes_at_milestone.push_back(current_nodes);
+                memory_samples.push_back(MemorySample{current_words, alloc_snapshot(), current_rss_kb()});
+                double nodes_per_char = static_cast<double>(current_nodes) / total_chars;
+                double compression_ratio = static_cast<double>(total_chars) / current_nodes;
             
-            std::cout << std::setw(8) << current_words << " | " 
-                      << std::setw(8) << total_chars << " | " 
-                      << std::setw(8) << current_nodes << " | " 
-                      << std::setw(10) << std::fixed << std::setprecision(4) << nodes_per_char << " | "
-                      << std::setw(10) << std::fixed << std::setprecision(4) << compression_ratio 
-                      << std::endl;
-            next_milestone_idx++;
-        }
+                std::cout << std::setw(8) << current_words << " | " 
+                          << std::setw(8) << total_chars << " | " 
+                          << std::setw(8) << current_nodes << " | " 
+                          << std::setw(10) << std::fixed << std::setprecision(4) << nodes_per_char << " | "
+                          << std::setw(10) << std::fixed << std::setprecision(4) << compression_ratio 
+                          << std::endl;
+                next_milestone_idx++;
+            }
         
-        // Mostrar progreso adicional cada 10000 palabras
-        if ((i + 1) % 10000 == 0 && next_milestone_idx >= milestones.size()) {
-            std::cout << "Insertadas " << (i + 1) << " palabras..." << std::endl;
+            // Mostrar progreso adicional cada 10000 palabras
+            if ((i + 1) % 10000 == 0 && next_milestone_idx >= milestones.size()) {
+                std::cout << "Insertadas " << (i + 1) << " palabras..." << std::endl;
+            }
         }
-    }
     
-    end_time = std::chrono::high_resolution_clock::now();
-    auto build_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+        end_time = std::chrono::high_resolution_clock::now();
+        auto build_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     
-    std::cout << "--------------------------------------------" << std::endl;
-    std::cout << "Trie construido en " << build_duration.count() << " ms" << std::endl;
+        std::cout << "--------------------------------------------" << std::endl;
+        std::cout << "Trie construido en " << build_duration.count() << " ms" << std::endl;
+        std::cout << "Memoria de la arena: " << trie.arena_bytes() / 1024 << " KB" << std::endl;
+        std::cout << "Peak RSS: " << peak_rss_kb() << " KB" << std::endl;
+        print_memory_samples(memory_samples, build_start);
+        print_measured_vs_approx(trie, alloc_snapshot());
     
-    // Estadísticas finales
-    std::cout << "\n=== Estadísticas Finales ===" << std::endl;
-    trie.print_stats();
+        // Estadísticas finales
+        std::cout << "\n=== Estadísticas Finales ===" << std::endl;
+        trie.print_stats();
+        print_node_kinds(trie);
+        compare_with_louds(trie);
+        compare_word_storage(trie);
     
-    // Ejecutar la interfaz interactiva
-    run_autocomplete(trie, mode_str);
+        if (compare_radix) {
+            compare_with_radix(words, variant, milestones, nodes_at_milestone);
+        }
+
+        // Ejecutar la interfaz interactiva
+        run_autocomplete(trie, mode_str);
     
-    return 0;
+        return 0;
+    });
 }
\ No newline at end of file
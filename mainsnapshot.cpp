@@ -0,0 +1,55 @@
+#include "trie.cpp"
+#include "corpus.cpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+// Construye el trie de un corpus y lo guarda como snapshot binario, para que
+// ./autocomplete lo abra con mmap en vez de reconstruirlo en cada inicio
+void show_usage() {
+    std::cout << "Uso: ./snapshot <dataset.txt> <salida.trie> [k]\n";
+    std::cout << "  dataset.txt: archivo de texto con una palabra por línea\n";
+    std::cout << "  salida.trie: archivo del snapshot\n";
+    std::cout << "  k: candidatos top-k por nodo (por defecto 5, como ./autocomplete)\n";
+    std::cout << "Ejemplo:\n";
+    std::cout << "  ./snapshot textos/words.txt textos/words.trie\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3 && argc != 4) {
+        show_usage();
+        return 1;
+    }
+
+    std::string filename = argv[1];
+    std::string output = argv[2];
+    size_t k = (argc == 4) ? std::stoul(argv[3]) : 5;
+
+    // Mismo filtro que ./autocomplete (palabras de 2 letras o más)
+    Corpus words = load_corpus(filename, Corpus::Split::LINES, 2);
+    if (words.empty()) {
+        std::cerr << "Error: No se pudieron cargar palabras del archivo" << std::endl;
+        return 1;
+    }
+
+    // Sin actualizaciones todas las prioridades son 0, así que el modo
+    // guardado no cambia el árbol; al abrirlo se usa el de la línea de comandos
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Trie<FrequentRanking> trie(k);
+    trie.build_parallel(words, default_thread_count(26));
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Trie construido en "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()
+              << " ms (" << trie.node_count() << " nodos, " << trie.word_count() << " palabras)" << std::endl;
+
+    start_time = std::chrono::high_resolution_clock::now();
+    if (!trie.save(output)) {
+        std::cerr << "Error: No se pudo escribir " << output << std::endl;
+        return 1;
+    }
+    end_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Snapshot guardado en " << output << " ("
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()
+              << " ms)" << std::endl;
+    return 0;
+}
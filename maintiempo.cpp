@@ -1,46 +1,106 @@
 #include "trie.cpp"
+#include "louds_trie.cpp"
+#include "corpus.cpp"
+#include "memory_stats.cpp"
 #include <fstream>
 #include <vector>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <cstdio>
+#include <thread>
 
-// Función para cargar palabras desde archivo
-std::vector<std::string> load_words_from_file(const std::string& filename) {
-    std::vector<std::string> words;
-    std::ifstream file(filename);
-    std::string word;
-    
-    if (!file.is_open()) {
-        std::cerr << "Error: No se pudo abrir " << filename << std::endl;
-        return words;
+// Compara dos tries nodo a nodo (por letra, no por índice de arena)
+template <class TrieT>
+bool same_trie(const TrieT& a, const TrieT& b) {
+    if (a.node_count() != b.node_count() || a.total_chars() != b.total_chars() ||
+        a.word_count() != b.word_count()) {
+        return false;
     }
-    
-    while (std::getline(file, word)) {
-        if (!word.empty()) {
-            words.push_back(word);
+    for (TrieTypes::Id w = 0; w < a.word_count(); ++w) {
+        if (a.word_at(w) != b.word_at(w)) return false;
+    }
+    auto word_of = [](const TrieT& t, TrieTypes::Id id) {
+        return id == TrieTypes::NONE ? TrieTypes::NONE : t.node(id)->word;
+    };
+    std::vector<std::pair<const TrieTypes::Node*, const TrieTypes::Node*>> stack = {{a.root(), b.root()}};
+    while (!stack.empty()) {
+        const TrieTypes::Node* u = stack.back().first;
+        const TrieTypes::Node* v = stack.back().second;
+        stack.pop_back();
+        if (u->kind != v->kind || u->count != v->count || u->word != v->word ||
+            u->priority != v->priority || u->best_priority() != v->best_priority() ||
+            word_of(a, u->best_terminal()) != word_of(b, v->best_terminal()) ||
+            u->topk_count != v->topk_count) {
+            return false;
+        }
+        for (int i = 0; i < u->topk_count; ++i) {
+            if (word_of(a, a.topk_[u->id * a.topk_cap_ + i]) != word_of(b, b.topk_[v->id * b.topk_cap_ + i]))
+                return false;
+        }
+        for (int k = 0; k < 27; ++k) {
+            TrieTypes::Id cu = a.child(u, k), cv = b.child(v, k);
+            if ((cu == TrieTypes::NONE) != (cv == TrieTypes::NONE)) return false;
+            if (cu != TrieTypes::NONE) stack.push_back({a.node(cu), b.node(cv)});
         }
     }
-    file.close();
-    return words;
+    return true;
+}
+
+// Memoria y búsqueda de una instancia de BasicTrie sobre el archivo cargado
+// con su propio alfabeto
+struct AlphabetResult {
+    const char* name;
+    size_t words, distinct, nodes, memory_bytes;
+    double build_ms, lookup_ns_per_char;
+};
+
+template <class TrieT>
+AlphabetResult measure_alphabet(const std::string& filename) {
+    typedef typename TrieT::AlphabetType Alphabet;
+    Corpus words = load_corpus<Alphabet>(filename, Corpus::Split::LINES);
+    TrieT trie;
+    auto start_build = std::chrono::high_resolution_clock::now();
+    for (std::string_view w : words) trie.insert(w);
+    auto end_build = std::chrono::high_resolution_clock::now();
+
+    size_t chars = 0, found = 0;
+    auto start_lookup = std::chrono::high_resolution_clock::now();
+    for (std::string_view w : words) {
+        typename TrieT::Cursor cursor(trie);
+        for (char c : w)
+            if (!cursor.advance(c)) break;
+        found += cursor.valid() && cursor.terminal();
+        chars += w.length();
+    }
+    auto end_lookup = std::chrono::high_resolution_clock::now();
+    if (found != words.size()) std::cerr << "Error: faltan palabras en el trie " << Alphabet::NAME << std::endl;
+
+    return AlphabetResult{Alphabet::NAME, words.size(), trie.word_count(), trie.node_count(),
+                          trie.approx_memory_bytes(),
+                          std::chrono::duration<double, std::milli>(end_build - start_build).count(),
+                          std::chrono::duration<double, std::nano>(end_lookup - start_lookup).count() /
+                              std::max<size_t>(chars, 1)};
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cout << "Uso: ./tiempo <dataset.txt> <modo>\n";
+    if (argc != 3 && argc != 4) {
+        std::cout << "Uso: ./tiempo <dataset.txt> <modo> [max_hilos]\n";
         std::cout << "  modo: 'reciente' o 'frecuente'\n";
+        std::cout << "  max_hilos: construcción en paralelo con 1..max_hilos hilos (por defecto, los núcleos)\n";
         return 1;
     }
     
     std::string filename = argv[1];
     std::string mode_str = argv[2];
+    size_t max_threads = (argc == 4) ? std::stoul(argv[3]) : default_thread_count(64);
     
     // Validar modo
-    Trie::Variant variant;
+    TrieTypes::Variant variant;
     if (mode_str == "reciente") {
-        variant = Trie::Variant::MOST_RECENT;
+        variant = TrieTypes::Variant::MOST_RECENT;
     } else if (mode_str == "frecuente") {
-        variant = Trie::Variant::MOST_FREQUENT;
+        variant = TrieTypes::Variant::MOST_FREQUENT;
     } else {
         std::cerr << "Error: Modo debe ser 'reciente' o 'frecuente'" << std::endl;
         return 1;
@@ -48,7 +108,7 @@ int main(int argc, char* argv[]) {
     
     // Cargar palabras
     std::cout << "Cargando palabras desde " << filename << "..." << std::endl;
-    auto words = load_words_from_file(filename);
+    auto words = load_corpus(filename, Corpus::Split::LINES);
     if (words.empty()) {
         std::cerr << "Error: No se pudieron cargar palabras" << std::endl;
         return 1;
@@ -56,49 +116,168 @@ int main(int argc, char* argv[]) {
     
     std::cout << "Palabras cargadas: " << words.size() << std::endl;
     
-    // Medir tiempo de construcción del trie
-    auto start_build = std::chrono::high_resolution_clock::now();
+    return with_ranking(variant, [&](auto ranking) {
+        typedef decltype(ranking) Ranking;
+
+        // Medir tiempo de construcción del trie
+        auto start_build = std::chrono::high_resolution_clock::now();
     
-    Trie trie(variant);
-    for (size_t i = 0; i < words.size(); ++i) {
-        trie.insert(words[i]);
-        if ((i + 1) % 10000 == 0) {
-            std::cout << "Insertadas " << (i + 1) << " palabras..." << std::endl;
+        Trie<Ranking> trie;
+        for (size_t i = 0; i < words.size(); ++i) {
+            trie.insert(words[i]);
+            if ((i + 1) % 10000 == 0) {
+                std::cout << "Insertadas " << (i + 1) << " palabras..." << std::endl;
+            }
         }
-    }
     
-    auto end_build = std::chrono::high_resolution_clock::now();
-    auto build_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_build - start_build);
+        auto end_build = std::chrono::high_resolution_clock::now();
+        auto build_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_build - start_build);
+        double build_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_build - start_build).count() / 1000.0;
     
-    // Medir tiempo de búsquedas
-    auto start_search = std::chrono::high_resolution_clock::now();
+        // Construcción en paralelo por primera letra, comparada contra la secuencial
+        std::cout << "\n=== Construcción en paralelo ===" << std::endl;
+        std::cout << std::setw(6) << "Hilos" << " | " << std::setw(10) << "ms" << " | "
+                  << std::setw(8) << "Speedup" << " | " << "Igual a secuencial" << std::endl;
+        for (size_t t = 1; t <= max_threads; ++t) {
+            Trie<Ranking> parallel;
+            auto start_parallel = std::chrono::high_resolution_clock::now();
+            parallel.build_parallel(words, t);
+            auto end_parallel = std::chrono::high_resolution_clock::now();
+            double ms = std::chrono::duration_cast<std::chrono::microseconds>(
+                end_parallel - start_parallel).count() / 1000.0;
+            std::cout << std::setw(6) << t << " | " << std::setw(10) << std::fixed << std::setprecision(2) << ms
+                      << " | " << std::setw(8) << std::setprecision(2) << (build_ms / ms) << " | "
+                      << (same_trie(trie, parallel) ? "sí" : "NO") << std::endl;
+        }
     
-    size_t total_chars = 0;
-    for (const auto& word : words) {
-        Trie::Node* current = trie.root_;
-        for (char c : word) {
-            current = trie.descend(current, c);
-            if (!current) break;
+        // Guardar y reabrir como snapshot: open() solo mapea, no reconstruye
+        std::string snapshot_path = "resultados/tiempo.trie";
+        auto start_save = std::chrono::high_resolution_clock::now();
+        bool saved = trie.save(snapshot_path);
+        auto end_save = std::chrono::high_resolution_clock::now();
+        if (saved) {
+            Trie<Ranking> opened;
+            auto start_open = std::chrono::high_resolution_clock::now();
+            bool ok = opened.open(snapshot_path);
+            auto end_open = std::chrono::high_resolution_clock::now();
+            std::cout << "\n=== Snapshot ===" << std::endl;
+            std::cout << "Guardado en " << std::fixed << std::setprecision(2)
+                      << std::chrono::duration_cast<std::chrono::microseconds>(end_save - start_save).count() / 1000.0
+                      << " ms, abierto en "
+                      << std::chrono::duration_cast<std::chrono::microseconds>(end_open - start_open).count() / 1000.0
+                      << " ms (construcción: " << build_ms << " ms)" << std::endl;
+            std::cout << "Igual al original: " << (ok && same_trie(trie, opened) ? "sí" : "NO") << std::endl;
+            std::remove(snapshot_path.c_str());
+        } else {
+            std::cerr << "Error: No se pudo guardar " << snapshot_path << std::endl;
         }
-        total_chars += word.length();
-    }
+
+        // Medir tiempo de búsquedas: todas las palabras de a una, que es el
+        // tiempo que se reporta. Después las mismas por lotes con
+        // descend_batch como dato aparte: las palabras van en el orden del
+        // texto y las frecuentes quedan en caché, así que el intercalado casi
+        // no tiene fallos que solapar y en general sale más lento
+        std::vector<std::string_view> queries;
+        queries.reserve(words.size());
+        size_t total_chars = 0;
+        for (std::string_view word : words) {
+            queries.push_back(word);
+            total_chars += word.length();
+        }
+        std::vector<TrieTypes::Node*> found(queries.size());
+        trie.descend_batch(queries.data(), queries.size(), found.data());   // calentar la caché
+    
+        std::vector<TrieTypes::Node*> serial(queries.size());
+        auto start_serial = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            TrieTypes::Node* current = trie.root_;
+            for (char c : queries[i]) {
+                current = trie.descend(current, c);
+                if (!current) break;
+            }
+            serial[i] = current;
+        }
+        auto end_serial = std::chrono::high_resolution_clock::now();
+        auto search_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_serial - start_serial);
     
-    auto end_search = std::chrono::high_resolution_clock::now();
-    auto search_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_search - start_search);
+        auto start_batch = std::chrono::high_resolution_clock::now();
+        trie.descend_batch(queries.data(), queries.size(), found.data());
+        auto end_batch = std::chrono::high_resolution_clock::now();
+        std::cout << "\n=== Búsqueda por lotes ===" << std::endl;
+        std::cout << "De a una: " << std::fixed << std::setprecision(2)
+                  << std::chrono::duration_cast<std::chrono::microseconds>(end_serial - start_serial).count() / 1000.0
+                  << " ms, por lotes: "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(end_batch - start_batch).count() / 1000.0
+                  << " ms" << std::endl;
+        std::cout << "Mismos nodos: " << (serial == found ? "sí" : "NO") << std::endl;
+
+        // Mismas búsquedas con autocompletado en el trie de nodos y en el LOUDS congelado
+        LoudsTrie louds(trie);
+        auto time_lookups = [&](auto&& lookup) {
+            size_t found = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (std::string_view word : words) found += lookup(word);
+            auto end = std::chrono::high_resolution_clock::now();
+            return std::make_pair(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), found);
+        };
+        auto trie_lookup = time_lookups([&](std::string_view word) {
+            TrieTypes::Node* current = trie.root_;
+            for (char c : word) {
+                current = trie.descend(current, c);
+                if (!current) return 0;
+            }
+            return trie.autocomplete(current) ? 1 : 0;
+        });
+        auto louds_lookup = time_lookups([&](std::string_view word) {
+            LoudsTrie::Position p = louds.root();
+            for (char c : word) {
+                p = louds.descend(p, c);
+                if (!p) return 0;
+            }
+            return louds.autocomplete(p) != LoudsTrie::NONE ? 1 : 0;
+        });
+        std::cout << "\n=== Búsqueda: nodos vs LOUDS ===" << std::endl;
+        std::cout << std::setw(6) << "" << " | " << std::setw(10) << "ms" << " | " << std::setw(10) << "ns/car"
+                  << " | " << std::setw(10) << "Memoria KB" << std::endl;
+        auto lookup_row = [&](const char* name, int64_t ns, size_t bytes) {
+            std::cout << std::setw(6) << name << " | " << std::setw(10) << std::fixed << std::setprecision(2)
+                      << ns / 1e6 << " | " << std::setw(10) << static_cast<double>(ns) / total_chars << " | "
+                      << std::setw(10) << bytes / 1024 << std::endl;
+        };
+        lookup_row("Trie", trie_lookup.first, trie.approx_memory_bytes());
+        lookup_row("LOUDS", louds_lookup.first, louds.memory_bytes());
+        std::cout << "Mismos resultados: " << (trie_lookup.second == louds_lookup.second ? "sí" : "NO") << std::endl;
+    
+        // El mismo archivo con el alfabeto ASCII y con el español (UTF-8)
+        AlphabetResult alphabets[] = {measure_alphabet<Trie<Ranking>>(filename),
+                                      measure_alphabet<SpanishTrie<Ranking>>(filename)};
+        std::cout << "\n=== Alfabeto: ASCII vs español ===" << std::endl;
+        std::cout << std::setw(8) << "Alfabeto" << " | " << std::setw(9) << "Distintas" << " | " << std::setw(9)
+                  << "Nodos" << " | " << std::setw(10) << "Memoria KB" << " | " << std::setw(10) << "Constr. ms"
+                  << " | " << std::setw(10) << "ns/car" << std::endl;
+        for (const AlphabetResult& r : alphabets) {
+            std::cout << std::setw(8) << r.name << " | " << std::setw(9) << r.distinct << " | " << std::setw(9)
+                      << r.nodes << " | " << std::setw(10) << r.memory_bytes / 1024 << " | " << std::setw(10)
+                      << std::fixed << std::setprecision(2) << r.build_ms << " | " << std::setw(10)
+                      << r.lookup_ns_per_char << std::endl;
+        }
     
-    // Resultados
-    std::cout << "\n=== RESULTADOS DE TIEMPO ===" << std::endl;
-    std::cout << "Dataset: " << filename << std::endl;
-    std::cout << "Modo: " << mode_str << std::endl;
-    std::cout << "Palabras: " << words.size() << std::endl;
-    std::cout << "Nodos en el trie: " << trie.node_count() << std::endl;
-    std::cout << "Tiempo de construcción: " << build_time.count() << " ms" << std::endl;
-    std::cout << "Tiempo de búsqueda: " << search_time.count() << " ms" << std::endl;
-    std::cout << "Tiempo total: " << (build_time + search_time).count() << " ms" << std::endl;
-    std::cout << "Tiempo promedio por palabra: " << std::fixed << std::setprecision(4) 
-              << (build_time.count() / (double)words.size()) << " ms" << std::endl;
-    std::cout << "Tiempo promedio por carácter: " << std::fixed << std::setprecision(4)
-              << ((build_time + search_time).count() * 1000.0 / total_chars) << " μs" << std::endl;
+        // Resultados
+        std::cout << "\n=== RESULTADOS DE TIEMPO ===" << std::endl;
+        std::cout << "Dataset: " << filename << std::endl;
+        std::cout << "Modo: " << mode_str << std::endl;
+        std::cout << "Palabras: " << words.size() << std::endl;
+        std::cout << "Nodos en el trie: " << trie.node_count() << std::endl;
+        std::cout << "Tiempo de construcción: " << build_time.count() << " ms" << std::endl;
+        std::cout << "Memoria de la arena: " << trie.arena_bytes() / 1024 << " KB" << std::endl;
+        std::cout << "Peak RSS: " << peak_rss_kb() << " KB" << std::endl;
+        std::cout << "Tiempo de búsqueda: " << search_time.count() << " ms" << std::endl;
+        std::cout << "Tiempo total: " << (build_time + search_time).count() << " ms" << std::endl;
+        std::cout << "Tiempo promedio por palabra: " << std::fixed << std::setprecision(4) 
+                  << (build_time.count() / (double)words.size()) << " ms" << std::endl;
+        std::cout << "Tiempo promedio por carácter: " << std::fixed << std::setprecision(4)
+                  << ((build_time + search_time).count() * 1000.0 / total_chars) << " μs" << std::endl;
     
-    return 0;
+        return 0;
+    });
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "tokenizer.cpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Microbenchmark del tokenizador: normaliza el mismo archivo con cada
+// kernel disponible y con la versión original (std::isalpha/std::tolower
+// byte a byte), y reporta GB/s de entrada. Todas deben dar los mismos tokens.
+
+// Tokens como (offset, largo) dentro del buffer normalizado, igual que Corpus
+typedef std::vector<std::pair<uint32_t, uint32_t>> Tokens;
+
+struct Result {
+    size_t tokens = 0;
+    uint64_t checksum = 14695981039346656037ull;   // FNV-1a de los tokens, en orden
+
+    // Fuera de la medición: solo resume lo que se emitió
+    Result(const char* data, const Tokens& ts) : tokens(ts.size()) {
+        for (auto [offset, length] : ts) {
+            for (size_t i = 0; i < length; ++i)
+                checksum = (checksum ^ static_cast<unsigned char>(data[offset + i])) * 1099511628211ull;
+            checksum = (checksum ^ '\n') * 1099511628211ull;
+        }
+    }
+    bool operator==(const Result& o) const { return tokens == o.tokens && checksum == o.checksum; }
+};
+
+// Lo que hacía Corpus::tokenize antes de Tokenizer
+static void run_legacy(char* data, size_t n, bool whitespace, size_t min_length, Tokens& out_tokens) {
+    size_t out = 0, i = 0;
+    while (i < n) {
+        size_t start = out;
+        while (i < n) {
+            unsigned char c = static_cast<unsigned char>(data[i]);
+            if (c == '\n' || (whitespace && std::isspace(c))) break;
+            if (std::isalpha(c)) data[out++] = static_cast<char>(std::tolower(c));
+            ++i;
+        }
+        ++i;
+        size_t length = out - start;
+        if (length >= min_length && length > 0) {
+            out_tokens.emplace_back(start, length);
+        } else {
+            out = start;
+        }
+    }
+}
+
+static void run_kernel(const Tokenizer::Kernel& k, char* data, size_t n, bool whitespace, size_t min_length,
+                       Tokens& out_tokens) {
+    Tokenizer::run(k, data, n, whitespace, min_length, true,
+                   [&](size_t offset, size_t length) { out_tokens.emplace_back(offset, length); });
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cout << "Uso: ./tokenizer <archivo.txt> [separador] [repeticiones]\n";
+        std::cout << "  separador: 'lineas' o 'espacios' (por defecto, espacios)\n";
+        std::cout << "  repeticiones: pasadas por kernel; se informa la mejor (por defecto 5)\n";
+        return 1;
+    }
+
+    std::string filename = argv[1];
+    bool whitespace = (argc < 3) || std::string(argv[2]) != "lineas";
+    size_t reps = (argc == 4) ? std::stoul(argv[3]) : 5;
+    const size_t min_length = 1;
+
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
+        return 1;
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::cout << "Archivo: " << filename << " (" << text.size() / (1024 * 1024) << " MB), separador: "
+              << (whitespace ? "espacios" : "lineas") << ", " << reps << " repeticiones" << std::endl;
+
+    // Cada pasada trabaja sobre una copia nueva porque la normalización es
+    // en el lugar; la copia queda fuera de la medición
+    std::vector<char> work(text.size());
+    Tokens tokens;
+    tokens.reserve(text.size() / 2 + 1);
+    auto measure = [&](auto&& fn, double& best_ns) {
+        for (size_t r = 0; r < reps; ++r) {
+            std::copy(text.begin(), text.end(), work.begin());
+            tokens.clear();
+            auto start = std::chrono::high_resolution_clock::now();
+            fn(work.data(), work.size());
+            auto end = std::chrono::high_resolution_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            if (r == 0 || ns < best_ns) best_ns = ns;
+        }
+        return Result(work.data(), tokens);
+    };
+
+    std::cout << std::setw(10) << "Kernel" << " | " << std::setw(10) << "ms" << " | " << std::setw(8) << "GB/s"
+              << " | " << std::setw(10) << "Tokens" << " | " << "Mismos tokens" << std::endl;
+    auto print_row = [&](const char* name, double ns, const Result& r, const Result& reference) {
+        std::cout << std::setw(10) << name << " | " << std::setw(10) << std::fixed << std::setprecision(2)
+                  << ns / 1e6 << " | " << std::setw(8) << text.size() / ns << " | " << std::setw(10) << r.tokens
+                  << " | " << (r == reference ? "si" : "NO") << std::endl;
+    };
+
+    double ns = 0;
+    Result reference = measure([&](char* d, size_t n) { run_legacy(d, n, whitespace, min_length, tokens); }, ns);
+    print_row("original", ns, reference, reference);
+
+    const Tokenizer::Kernel* kernels[3];
+    size_t count = Tokenizer::available_kernels(kernels);
+    bool all_equal = true;
+    for (size_t i = 0; i < count; ++i) {
+        Result r = measure([&](char* d, size_t n) { run_kernel(*kernels[i], d, n, whitespace, min_length, tokens); },
+                           ns);
+        print_row(kernels[i]->name, ns, r, reference);
+        all_equal = all_equal && r == reference;
+    }
+    std::cout << "Kernel elegido en tiempo de ejecución: " << Tokenizer::kernel().name << std::endl;
+    return all_equal ? 0 : 1;
+}
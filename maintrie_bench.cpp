@@ -0,0 +1,281 @@
+#include "trie.cpp"
+#include "corpus.cpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sys/stat.h>
+#include <vector>
+
+// Suite de benchmarks del trie con escenarios repetibles. Cada escenario
+// corre primero `warmup` pasadas sin medir y después `reps` repeticiones;
+// en cada una se mide el throughput de la pasada completa y, en otra pasada
+// igual, la latencia de cada operación por separado (así el costo del reloj
+// no ensucia el throughput). Los resultados van a
+// resultados/bench_<etiqueta>.csv y .json para comparar entre builds con
+// graficar.py.
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// Evita que el compilador descarte una operación cuyo resultado no se usa
+template <class T> inline void keep(const T& v) { asm volatile("" : : "g"(v) : "memory"); }
+
+struct BenchResult {
+    std::string scenario;
+    std::string mode;
+    size_t ops = 0;                    // operaciones por repetición
+    size_t reps = 0;
+    double ops_per_s = 0;              // mediana de las repeticiones
+    double p50 = 0, p90 = 0, p99 = 0, max = 0;   // ns por operación
+};
+
+struct BenchConfig {
+    size_t warmup = 1;
+    size_t reps = 5;
+};
+
+// setup() deja el estado inicial de una pasada (fuera de la medición) y
+// op(i) es la i-ésima operación de la pasada
+template <class Setup, class Op>
+BenchResult run_scenario(const std::string& scenario, const std::string& mode, size_t ops,
+                         const BenchConfig& cfg, Setup&& setup, Op&& op) {
+    for (size_t w = 0; w < cfg.warmup; ++w) {
+        setup();
+        for (size_t i = 0; i < ops; ++i) op(i);
+    }
+
+    std::vector<double> throughput;
+    std::vector<uint32_t> samples;
+    samples.reserve(ops * cfg.reps);
+    for (size_t r = 0; r < cfg.reps; ++r) {
+        setup();
+        auto start = Clock::now();
+        for (size_t i = 0; i < ops; ++i) op(i);
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        throughput.push_back(ops / (ns / 1e9));
+
+        setup();
+        for (size_t i = 0; i < ops; ++i) {
+            auto a = Clock::now();
+            op(i);
+            auto b = Clock::now();
+            samples.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+        }
+    }
+
+    BenchResult res;
+    res.scenario = scenario;
+    res.mode = mode;
+    res.ops = ops;
+    res.reps = cfg.reps;
+    std::sort(throughput.begin(), throughput.end());
+    res.ops_per_s = throughput[throughput.size() / 2];
+    if (!samples.empty()) {
+        std::sort(samples.begin(), samples.end());
+        auto pct = [&](double p) { return static_cast<double>(samples[static_cast<size_t>(p * (samples.size() - 1))]); };
+        res.p50 = pct(0.50);
+        res.p90 = pct(0.90);
+        res.p99 = pct(0.99);
+        res.max = samples.back();
+    }
+    return res;
+}
+
+// Costo de una lectura del reloj (mínimo de muchas), para interpretar las
+// latencias más chicas
+double clock_cost_ns() {
+    double best = 1e9;
+    for (int i = 0; i < 1000; ++i) {
+        auto a = Clock::now();
+        auto b = Clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(b - a).count());
+    }
+    return best;
+}
+
+// Todos los escenarios con el trie en el modo dado
+template <class Ranking>
+void run_mode(const Corpus& words, const std::string& mode, const BenchConfig& cfg,
+              std::vector<BenchResult>& results) {
+    typedef Trie<Ranking> TrieT;
+    size_t n = words.size();
+    TrieT trie;
+    auto build = [&] {
+        trie.reset();
+        for (size_t i = 0; i < n; ++i) trie.insert(words[i]);
+    };
+
+    // Inserción en bloque: todas las palabras del corpus en un trie vacío
+    results.push_back(run_scenario("insert", mode, n, cfg, [&] { trie.reset(); },
+                                   [&](size_t i) { keep(trie.insert(words[i])); }));
+
+    // Búsqueda exacta: bajar la palabra completa y su '$'
+    build();
+    results.push_back(run_scenario("lookup", mode, n, cfg, [] {}, [&](size_t i) {
+        typename TrieT::Cursor cursor(trie);
+        for (char c : words[i])
+            if (!cursor.advance(c)) break;
+        keep(cursor.terminal());
+    }));
+
+    // Prefijos completos de a uno (descend encadenado) contra descend_batch
+    // con lotes de b = 1..MAX_BATCH. En los lotes una operación del
+    // escenario es un lote entero; el resultado se pasa a palabras (ops/s
+    // por palabra y latencia del lote dividida por b) para comparar directo
+    std::vector<std::string_view> queries;
+    queries.reserve(n);
+    for (std::string_view w : words) queries.push_back(w);
+    std::vector<TrieTypes::Node*> found(n);
+    results.push_back(run_scenario("prefijo_serie", mode, n, cfg, [] {}, [&](size_t i) {
+        TrieTypes::Node* u = trie.root();
+        for (char c : queries[i])
+            if (!(u = trie.descend(u, c))) break;
+        found[i] = u;
+    }));
+    for (size_t b = 1; b <= TrieT::MAX_BATCH; b *= 2) {
+        size_t batches = (n + b - 1) / b;
+        BenchResult r = run_scenario("prefijo_lote" + std::to_string(b), mode, batches, cfg, [] {}, [&](size_t i) {
+            size_t from = i * b;
+            trie.descend_batch(&queries[from], std::min(b, n - from), &found[from]);
+        });
+        r.ops = n;
+        r.ops_per_s *= static_cast<double>(n) / batches;
+        r.p50 /= b;
+        r.p90 /= b;
+        r.p99 /= b;
+        r.max /= b;
+        results.push_back(r);
+    }
+    keep(found.back());
+
+    // Autocompletado de un prefijo desde la raíz; el largo del prefijo
+    // recorre 1..largo de la palabra para cubrir prefijos cortos y largos
+    results.push_back(run_scenario("autocomplete", mode, n, cfg, [] {}, [&](size_t i) {
+        std::string_view w = words[i];
+        size_t len = 1 + i % w.size();
+        typename TrieT::Cursor cursor(trie);
+        for (size_t j = 0; j < len && cursor.advance(w[j]); ++j) {
+        }
+        keep(cursor.valid() ? cursor.suggestion() : nullptr);
+    }));
+
+    // update_priority sobre los terminales en el orden del corpus; cada
+    // repetición parte del trie recién construido. En decaimiento una de
+    // cada RESCALE_BITS * HALF_LIFE actualizaciones reescala toda la arena:
+    // ese pico queda en el max, no en la mediana
+    std::vector<TrieTypes::Id> terminals(n);
+    results.push_back(run_scenario(
+        "update_priority", mode, n, cfg,
+        [&] {
+            build();
+            for (size_t i = 0; i < n; ++i) terminals[i] = trie.insert(words[i])->id;
+        },
+        [&](size_t i) { trie.update_priority(trie.node(terminals[i])); }));
+
+    // El pico por sí solo: un reescalado de todas las prioridades, O(nodos)
+    if constexpr (requires(int64_t& clock) { Ranking::rescale(clock); }) {
+        results.push_back(run_scenario("reescalado", mode, 20, cfg, [] {},
+                                       [&](size_t) { trie.rescale_priorities(Ranking::RESCALE_BITS); }));
+    }
+
+    // Simulación completa de tecleo (como ./simulation): una operación es
+    // escribir una palabra tecla a tecla hasta que la sugerencia sea ella y
+    // actualizar su prioridad
+    results.push_back(run_scenario("simulation", mode, n, cfg, build, [&](size_t i) {
+        typename TrieT::Cursor cursor(trie);
+        TrieTypes::Node* previous = nullptr;
+        size_t run_start = 0;
+        for (char c : words[i]) {
+            if (!cursor.advance(c)) break;
+            TrieTypes::Node* suggestion = cursor.suggestion();
+            if (suggestion != previous) {
+                previous = suggestion;
+                run_start = cursor.depth;
+            }
+        }
+        TrieTypes::Node* terminal = cursor.valid() ? cursor.terminal() : nullptr;
+        keep(run_start);
+        if (terminal) trie.update_priority(terminal);
+    }));
+}
+
+bool write_csv(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "escenario,modo,operaciones,repeticiones,ops_por_s,p50_ns,p90_ns,p99_ns,max_ns\n";
+    out << std::fixed << std::setprecision(1);
+    for (const BenchResult& r : results) {
+        out << r.scenario << "," << r.mode << "," << r.ops << "," << r.reps << "," << r.ops_per_s << ","
+            << r.p50 << "," << r.p90 << "," << r.p99 << "," << r.max << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool write_json(const std::string& path, const std::string& label, const std::string& dataset,
+                const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << std::fixed << std::setprecision(1);
+    out << "{\n  \"etiqueta\": \"" << label << "\",\n  \"dataset\": \"" << dataset << "\",\n  \"escenarios\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\"escenario\": \"" << r.scenario << "\", \"modo\": \"" << r.mode << "\", \"operaciones\": " << r.ops
+            << ", \"repeticiones\": " << r.reps << ", \"ops_por_s\": " << r.ops_per_s << ", \"p50_ns\": " << r.p50
+            << ", \"p90_ns\": " << r.p90 << ", \"p99_ns\": " << r.p99 << ", \"max_ns\": " << r.max << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 5) {
+        std::cout << "Uso: ./trie_bench <dataset.txt> [etiqueta] [repeticiones] [calentamiento]\n";
+        std::cout << "  etiqueta: nombre de esta corrida (p.ej. el commit); por defecto 'actual'\n";
+        std::cout << "  repeticiones: pasadas medidas por escenario (por defecto 5)\n";
+        std::cout << "  calentamiento: pasadas sin medir antes de las repeticiones (por defecto 1)\n";
+        std::cout << "Salida: resultados/bench_<etiqueta>.csv y resultados/bench_<etiqueta>.json\n";
+        return 1;
+    }
+
+    std::string filename = argv[1];
+    std::string label = (argc >= 3) ? argv[2] : "actual";
+    BenchConfig cfg;
+    if (argc >= 4) cfg.reps = std::max<size_t>(1, std::stoul(argv[3]));
+    if (argc >= 5) cfg.warmup = std::stoul(argv[4]);
+
+    Corpus words = load_corpus(filename, Corpus::Split::WHITESPACE);
+    if (words.empty()) {
+        std::cerr << "Error: No se pudieron cargar palabras del archivo" << std::endl;
+        return 1;
+    }
+    std::cout << "Dataset: " << filename << " (" << words.size() << " palabras), " << cfg.reps
+              << " repeticiones, " << cfg.warmup << " de calentamiento" << std::endl;
+    std::cout << "Costo de leer el reloj: " << std::fixed << std::setprecision(1) << clock_cost_ns()
+              << " ns (incluido en las latencias)" << std::endl;
+
+    std::vector<BenchResult> results;
+    run_mode<RecentRanking>(words, "reciente", cfg, results);
+    run_mode<FrequentRanking>(words, "frecuente", cfg, results);
+    run_mode<DecayedRanking<>>(words, "decaimiento", cfg, results);
+
+    std::cout << "\n" << std::setw(16) << "Escenario" << " | " << std::setw(11) << "Modo" << " | " << std::setw(12)
+              << "ops/s" << " | " << std::setw(8) << "p50 ns" << " | " << std::setw(8) << "p90 ns" << " | "
+              << std::setw(8) << "p99 ns" << " | " << std::setw(10) << "max ns" << std::endl;
+    std::cout << std::string(92, '-') << std::endl;
+    for (const BenchResult& r : results) {
+        std::cout << std::setw(16) << r.scenario << " | " << std::setw(11) << r.mode << " | " << std::setw(12)
+                  << std::setprecision(0) << r.ops_per_s << " | " << std::setw(8) << r.p50 << " | " << std::setw(8)
+                  << r.p90 << " | " << std::setw(8) << r.p99 << " | " << std::setw(10) << r.max << std::endl;
+    }
+
+    mkdir("resultados", 0755);
+    std::string base = "resultados/bench_" + label;
+    if (!write_csv(base + ".csv", results) || !write_json(base + ".json", label, filename, results)) {
+        std::cerr << "Error: No se pudieron escribir los resultados en " << base << ".csv/.json" << std::endl;
+        return 1;
+    }
+    std::cout << "\nResultados en " << base << ".csv y " << base << ".json" << std::endl;
+    return 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Memoria residente máxima del proceso (peak RSS) en KB
+inline size_t peak_rss_kb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<size_t>(usage.ru_maxrss);  // en Linux ya viene en KB
+}
+
+// Memoria residente actual en KB (segundo campo de /proc/self/statm)
+inline size_t current_rss_kb() {
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    size_t pages = 0, resident = 0;
+    int n = std::fscanf(f, "%zu %zu", &pages, &resident);
+    std::fclose(f);
+    return n == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024 : 0;
+}
+
+// --------------------------------------------------------
+// Atribución de asignaciones
+// --------------------------------------------------------
+// Cada asignación de heap se atribuye a la categoría activa en el hilo.
+// Las arenas y el cargador la fijan con MemTagScope alrededor de sus
+// asignaciones (pocas: una por chunk o por buffer). Solo cuesta guardar
+// un enum; los contadores existen recién si el ejecutable incluye
+// alloc_tracking.cpp.
+enum class MemTag : unsigned char { NODES, CHILDREN, WORDS, TOPK, LOADER, OTHER, COUNT };
+
+inline const char* mem_tag_name(MemTag t) {
+    static const char* names[] = {"nodos", "hijos", "palabras", "top-k", "carga", "otros"};
+    return names[static_cast<int>(t)];
+}
+
+inline thread_local MemTag current_mem_tag = MemTag::OTHER;
+
+struct MemTagScope {
+    MemTag saved;
+    explicit MemTagScope(MemTag t) : saved(current_mem_tag) { current_mem_tag = t; }
+    ~MemTagScope() { current_mem_tag = saved; }
+    MemTagScope(const MemTagScope&) = delete;
+    MemTagScope& operator=(const MemTagScope&) = delete;
+};
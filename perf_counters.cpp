@@ -0,0 +1,160 @@
+#pragma once
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_LINUX 1
+#endif
+
+// Contadores de hardware de Linux (perf_event_open) para ver si un recorrido
+// está limitado por fallos de caché, de TLB o por saltos mal predichos, cosa
+// que el tiempo de reloj no distingue. Los contadores cuentan solo este
+// hilo en modo usuario desde que se crea el objeto; una fase se mide como
+// la resta de dos lecturas.
+//
+// Cada evento se abre por separado: si el kernel, la VM o
+// perf_event_paranoid no dejan abrir alguno, ese queda inválido y el resto
+// sigue. Si ninguno abre, todas las lecturas son inválidas y quien escribe
+// los resultados deja el valor vacío. Cuando hay más eventos que contadores
+// físicos el kernel los turna; el valor se escala por tiempo activo.
+
+struct PerfCounters {
+    enum Event { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, DTLB_MISSES, BRANCH_MISSES, EVENT_COUNT };
+
+    struct Sample {
+        std::array<double, EVENT_COUNT> values{};
+        std::array<bool, EVENT_COUNT> valid{};
+
+        double operator[](Event e) const { return values[e]; }
+        bool has(Event e) const { return valid[e]; }
+
+        Sample operator-(const Sample& o) const {
+            Sample d;
+            for (size_t e = 0; e < EVENT_COUNT; ++e) {
+                d.valid[e] = valid[e] && o.valid[e];
+                d.values[e] = d.valid[e] ? values[e] - o.values[e] : 0;
+            }
+            return d;
+        }
+    };
+
+    // Nombre de cada evento en las columnas del csv
+    static const char* name(Event e) {
+        static const char* names[EVENT_COUNT] = {"ciclos", "instrucciones", "fallos_l1d",
+                                                 "fallos_llc", "fallos_dtlb", "fallos_saltos"};
+        return names[e];
+    }
+
+    PerfCounters() {
+        fds_.fill(-1);
+#ifdef PERF_COUNTERS_LINUX
+        auto cache = [](uint64_t id) {
+            return id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        const uint32_t types[EVENT_COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                             PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+        const uint64_t configs[EVENT_COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                               cache(PERF_COUNT_HW_CACHE_L1D), PERF_COUNT_HW_CACHE_MISSES,
+                                               cache(PERF_COUNT_HW_CACHE_DTLB), PERF_COUNT_HW_BRANCH_MISSES};
+        for (size_t e = 0; e < EVENT_COUNT; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds_[e] < 0 && error_.empty()) error_ = std::strerror(errno);
+        }
+#else
+        error_ = "solo disponibles en Linux";
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef PERF_COUNTERS_LINUX
+        for (int fd : fds_)
+            if (fd >= 0) close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    size_t available() const {
+        size_t n = 0;
+        for (int fd : fds_) n += fd >= 0;
+        return n;
+    }
+
+    // Valores acumulados desde la construcción
+    Sample read() const {
+        Sample s;
+#ifdef PERF_COUNTERS_LINUX
+        for (size_t e = 0; e < EVENT_COUNT; ++e) {
+            uint64_t v[3];   // valor, tiempo activo, tiempo contando
+            if (fds_[e] < 0 || ::read(fds_[e], v, sizeof(v)) != sizeof(v) || v[2] == 0) continue;
+            s.values[e] = static_cast<double>(v[0]) * (static_cast<double>(v[1]) / v[2]);
+            s.valid[e] = true;
+        }
+#endif
+        return s;
+    }
+
+    // Una línea con qué eventos se pudieron abrir
+    void print_status() const {
+        std::cout << "Contadores de hardware: " << available() << "/" << EVENT_COUNT << " disponibles";
+        if (available() < EVENT_COUNT) {
+            std::cout << " (faltan:";
+            for (size_t e = 0; e < EVENT_COUNT; ++e)
+                if (fds_[e] < 0) std::cout << " " << name(static_cast<Event>(e));
+            std::cout << "; perf_event_open: " << error_ << ")";
+        }
+        std::cout << std::endl;
+        if (available() == 0) std::cout << "Las columnas de contadores del csv quedan vacías" << std::endl;
+    }
+
+    // Resumen de una fase: eventos por tecla e instrucciones por ciclo
+    static void print_phase(const char* phase, const Sample& d, size_t keystrokes) {
+        std::cout << "Contadores (" << phase << ", por tecla):";
+        bool any = false;
+        for (size_t e = 0; e < EVENT_COUNT; ++e) {
+            if (!d.valid[e]) continue;
+            std::cout << " " << name(static_cast<Event>(e)) << "=" << std::fixed << std::setprecision(3)
+                      << d.values[e] / keystrokes;
+            any = true;
+        }
+        if (d.has(CYCLES) && d.has(INSTRUCTIONS) && d[CYCLES] > 0)
+            std::cout << " IPC=" << std::setprecision(2) << d[INSTRUCTIONS] / d[CYCLES];
+        std::cout << (any ? "" : " no disponibles") << std::endl;
+    }
+
+    // Columnas para el csv: ",ciclos_por_tecla,..." y sus valores (vacíos
+    // si el evento no está disponible)
+    static std::string csv_header() {
+        std::string h;
+        for (size_t e = 0; e < EVENT_COUNT; ++e) h += std::string(",") + name(static_cast<Event>(e)) + "_por_tecla";
+        return h;
+    }
+
+    static void write_csv(std::ostream& out, const Sample& d, size_t keystrokes) {
+        for (size_t e = 0; e < EVENT_COUNT; ++e) {
+            out << ",";
+            if (d.valid[e] && keystrokes) out << std::fixed << std::setprecision(4) << d.values[e] / keystrokes;
+        }
+    }
+
+private:
+    std::array<int, EVENT_COUNT> fds_;
+    std::string error_;                 // primer error de perf_event_open
+};
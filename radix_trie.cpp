@@ -0,0 +1,305 @@
+#pragma once
+#include "trie.cpp"
+
+// Trie comprimido (radix / Patricia): las cadenas de nodos con un solo hijo
+// se colapsan en una arista con etiqueta. Cada palabra termina en una hoja
+// cuya etiqueta acaba en '$', igual que el nodo '$' del Trie normal.
+// Mantiene la misma semántica de best_terminal para RECIENTE y FRECUENTE.
+
+struct RadixTrie {
+    // --------------------------------------------------------
+    // Tipos y estructuras
+    // --------------------------------------------------------
+    typedef TrieTypes::Variant Variant;
+    typedef TrieTypes::Id Id;
+    static const Id NONE = TrieTypes::NONE;
+
+    struct Node {
+        int64_t priority = 0;
+        int64_t best_priority = std::numeric_limits<int64_t>::min();
+        Id id = NONE;
+        Id parent = NONE;
+        Id kids = NONE;                // bloque de hijos en blocks_, por primer carácter
+        Id best_terminal = NONE;       // mejor terminal del subárbol
+        Id word = NONE;                // índice en words_ (solo terminal)
+        uint32_t label = 0;            // etiqueta de la arista: offset en labels_
+        uint32_t label_len = 0;
+        uint8_t kind = ChildBlocks::N0;
+        uint8_t count = 0;
+
+        bool is_terminal() const { return word != NONE; }
+    };
+
+    // Posición de tecleo: dentro de la arista que llega a `node`, con
+    // `depth` caracteres de su etiqueta ya consumidos
+    struct Position {
+        Node* node;
+        uint32_t depth;
+
+        Position(Node* n = nullptr, uint32_t d = 0) : node(n), depth(d) {}
+
+        explicit operator bool() const { return node != nullptr; }
+    };
+
+    // --------------------------------------------------------
+    // Atributos del trie
+    // --------------------------------------------------------
+    Variant variant;
+    Node* root_ = nullptr;
+    int64_t access_counter_ = 0;       // para modo reciente
+    size_t node_count_ = 0;            // cantidad de nodos
+    size_t total_chars_ = 0;           // total de caracteres insertados
+    WordPool words_;                   // palabras en orden de primera inserción
+    std::string labels_;               // pool de etiquetas de aristas
+    std::string key_;                  // buffer reutilizado por insert
+
+    ChunkArena<Node> nodes_{MemTag::NODES};
+    ChildBlocks blocks_;
+
+    // --------------------------------------------------------
+    // Constructor
+    // --------------------------------------------------------
+    RadixTrie(Variant v) : variant(v) {
+        reset(v);
+    }
+
+    void reset(Variant v) {
+        variant = v;
+        nodes_.clear();
+        blocks_.clear();
+        words_.clear();
+        labels_.clear();
+        access_counter_ = 0;
+        node_count_ = 0;
+        total_chars_ = 0;
+        root_ = new_node(NONE, 0, 0);
+    }
+
+    // --------------------------------------------------------
+    // Funciones auxiliares
+    // --------------------------------------------------------
+    Node* node(Id i) { return i == NONE ? nullptr : &nodes_[i]; }
+    const Node* node(Id i) const { return i == NONE ? nullptr : &nodes_[i]; }
+
+    std::string_view word(const Node* terminal) const { return words_[terminal->word]; }
+
+    char label_at(const Node* u, uint32_t i) const { return labels_[u->label + i]; }
+
+    Node* new_node(Id parent, uint32_t label, uint32_t label_len) {
+        Id i = nodes_.alloc();
+        Node* n = &nodes_[i];
+        n->id = i;
+        n->parent = parent;
+        n->label = label;
+        n->label_len = label_len;
+        ++node_count_;
+        blocks_.note_new_node();
+        return n;
+    }
+
+    // Hijo de u cuya etiqueta empieza con c
+    Node* find_child(const Node* u, char c) const {
+        int k = alphabet_index<AsciiAlphabet>(c);
+        if (k < 0) return nullptr;
+        return const_cast<Node*>(node(blocks_.child(u, k)));
+    }
+
+    void link_child(Node* u, Node* c) {
+        c->parent = u->id;
+        blocks_.add_child(u, alphabet_index<AsciiAlphabet>(label_at(c, 0)), c->id);
+    }
+
+    // Corta la arista de c tras `len` caracteres; el nodo intermedio hereda
+    // el mejor terminal de c porque su subárbol es el mismo
+    Node* split(Node* c, uint32_t len) {
+        Node* parent = node(c->parent);
+        Node* mid = new_node(parent->id, c->label, len);
+        mid->best_terminal = c->best_terminal;
+        mid->best_priority = c->best_priority;
+        blocks_.set_child(parent, alphabet_index<AsciiAlphabet>(label_at(c, 0)), mid->id);
+
+        c->label += len;
+        c->label_len -= len;
+        link_child(mid, c);
+        return mid;
+    }
+
+    // --------------------------------------------------------
+    // Operaciones principales
+    // --------------------------------------------------------
+
+    // Inserta una palabra y retorna su nodo terminal. Normaliza igual que
+    // Trie::insert (Tokenizer::normalize_word), así los tres tries guardan
+    // las mismas palabras aunque el texto traiga bytes no ASCII
+    Node* insert(std::string_view w_raw) {
+        std::string& key = key_;
+        if (Tokenizer::is_normalized<AsciiAlphabet>(w_raw)) key.assign(w_raw);
+        else key = Tokenizer::normalize_word<AsciiAlphabet>(w_raw);
+
+        if (key.empty()) return nullptr;
+        if (key.size() > WordPool::MAX_LENGTH) {
+            std::cerr << "Error: palabra de más de " << WordPool::MAX_LENGTH << " letras, no se inserta" << std::endl;
+            return nullptr;
+        }
+        total_chars_ += key.size() + 1; // caracteres + '$', igual que Trie
+        key.push_back('$');
+
+        Node* u = root_;
+        size_t i = 0;
+        Node* terminal = nullptr;
+        while (!terminal) {
+            Node* c = find_child(u, key[i]);
+            if (!c) {
+                // Hoja nueva con el resto de la palabra
+                Node* leaf = new_node(NONE, static_cast<uint32_t>(labels_.size()),
+                                      static_cast<uint32_t>(key.size() - i));
+                labels_.append(key, i, std::string::npos);
+                link_child(u, leaf);
+                terminal = leaf;
+                break;
+            }
+
+            uint32_t j = 0;
+            while (j < c->label_len && i + j < key.size() && label_at(c, j) == key[i + j]) ++j;
+
+            if (j == c->label_len) {
+                i += j;
+                if (i == key.size()) terminal = c; // la palabra ya existía
+                u = c;
+            } else {
+                u = split(c, j);
+                i += j;
+            }
+        }
+
+        if (!terminal->is_terminal()) {
+            terminal->word = words_.append(std::string_view(key).substr(0, key.size() - 1));
+            terminal->priority = 0;
+            propagate_if_better(terminal);
+        }
+        return terminal;
+    }
+
+    Position root() const { return Position{root_, 0}; }
+
+    // Avanza un carácter desde la posición p (una tecla a la vez)
+    Position descend(Position p, char c) const {
+        if (!p) return Position();
+        int k = alphabet_index<AsciiAlphabet>(c);
+        if (k < 0) return Position();
+        char cc = (k == AsciiAlphabet::END) ? '$' : static_cast<char>(AsciiAlphabet::SYMBOLS[k]);
+        if (p.depth < p.node->label_len) {
+            if (label_at(p.node, p.depth) != cc) return Position();
+            return Position{p.node, p.depth + 1};
+        }
+        Node* next = find_child(p.node, cc);
+        return next ? Position{next, 1} : Position();
+    }
+
+    // Mejor terminal: a mitad de arista todas las palabras pasan por p.node
+    Node* autocomplete(Position p) const {
+        if (!p) return nullptr;
+        return const_cast<Node*>(node(p.node->best_terminal));
+    }
+
+    // Misma interfaz que Trie::Cursor, avanzando sobre una Position
+    struct Cursor {
+        const RadixTrie* trie;
+        Position pos;
+        Node* term = nullptr;
+        size_t depth = 0;
+
+        explicit Cursor(const RadixTrie& t) : trie(&t), pos(t.root()) {}
+
+        bool advance(char c) {
+            pos = trie->descend(pos, c);
+            term = nullptr;
+            if (!pos) return false;
+            ++depth;
+            return true;
+        }
+
+        bool valid() const { return static_cast<bool>(pos); }
+        Node* node() const { return pos.node; }
+        Node* suggestion() const { return trie->autocomplete(pos); }
+
+        // Solo hay terminal si '$' cierra justo la etiqueta de una hoja
+        Node* terminal() {
+            if (!term && pos) {
+                Position p = trie->descend(pos, '$');
+                if (p && p.depth == p.node->label_len && p.node->is_terminal()) term = p.node;
+            }
+            return term;
+        }
+    };
+
+    // Igual que Trie::update_priority: prioridades solo crecen, así que se
+    // puede cortar en el primer ancestro que ya es mejor
+    void update_priority(Node* terminal) {
+        assert(terminal && terminal->is_terminal());
+
+        if (variant == Variant::MOST_RECENT) {
+            terminal->priority = ++access_counter_;
+        } else {
+            terminal->priority += 1;
+        }
+
+        terminal->best_priority = terminal->priority;
+        terminal->best_terminal = terminal->id;
+
+        Node* cur = node(terminal->parent);
+        while (cur) {
+            bool needs_update = cur->best_terminal == NONE ||
+                terminal->priority > cur->best_priority ||
+                (terminal->priority == cur->best_priority &&
+                 cur->best_terminal != terminal->id &&
+                 variant == Variant::MOST_RECENT);
+            if (!needs_update) break;
+            cur->best_priority = terminal->priority;
+            cur->best_terminal = terminal->id;
+            cur = node(cur->parent);
+        }
+    }
+
+    // --------------------------------------------------------
+    // Métricas
+    // --------------------------------------------------------
+    size_t node_count() const { return node_count_; }
+    size_t total_chars() const { return total_chars_; }
+    size_t word_count() const { return words_.size(); }
+
+    size_t approx_memory_bytes() const {
+        return node_count_ * sizeof(Node) + blocks_.bytes_ + labels_.size() + words_.memory_bytes();
+    }
+
+    void print_stats() const {
+        std::cout << "=== Estadísticas del Trie Radix ===" << std::endl;
+        std::cout << "Nodos totales: " << node_count_ << std::endl;
+        std::cout << "Palabras almacenadas: " << words_.size() << std::endl;
+        std::cout << "Caracteres totales insertados: " << total_chars_ << std::endl;
+        std::cout << "Bytes de etiquetas: " << labels_.size() << std::endl;
+        std::cout << "Memoria aproximada: " << approx_memory_bytes() << " bytes" << std::endl;
+        std::cout << "Memoria aproximada: " << approx_memory_bytes() / 1024.0 / 1024.0 << " MB" << std::endl;
+        std::cout << "Modo: " << (variant == Variant::MOST_RECENT ? "MÁS RECIENTE" : "MÁS FRECUENTE") << std::endl;
+        std::cout << "===================================" << std::endl;
+    }
+
+private:
+
+    void propagate_if_better(Node* terminal) {
+        terminal->best_priority = terminal->priority;
+        terminal->best_terminal = terminal->id;
+
+        Node* cur = node(terminal->parent);
+        while (cur) {
+            if (cur->best_terminal == NONE ||
+                terminal->priority > cur->best_priority) {
+                cur->best_priority = terminal->priority;
+                cur->best_terminal = terminal->id;
+                cur = node(cur->parent);
+            } else {
+                break;
+            }
+        }
+    }
+};
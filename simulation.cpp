@@ -1,4 +1,9 @@
 #include "trie.cpp"
+#include "corpus.cpp"
+#include "memory_stats.cpp"
+#include "radix_trie.cpp"
+#include "double_array_trie.cpp"
+#include "perf_counters.cpp"
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -8,59 +13,7 @@
 #include <cmath>
 #include <algorithm>
 #include <map>
-
-// Función para cargar palabras desde un archivo .txt
-std::vector<std::string> load_words_from_file(const std::string& filename) {
-    std::vector<std::string> words;
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
-        return words;
-    }
-    
-    std::cout << "Cargando palabras desde " << filename << "..." << std::endl;
-    
-    std::string line;
-    int total_words = 0;
-    
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string word;
-        
-        // Dividir la línea en palabras individuales
-        while (ss >> word) {
-            // convertir a minusculas y limpiar
-            std::string clean_word;
-            for (char c : word) {
-                if (std::isalpha((unsigned char)c)) {
-                    clean_word.push_back(std::tolower((unsigned char)c));
-                }
-            }
-            
-            if (!clean_word.empty() && clean_word.length() >= 1) {
-                words.push_back(clean_word);
-                total_words++;
-                
-                if (total_words % 100000 == 0) {
-                    std::cout << "Cargadas " << total_words << " palabras..." << std::endl;
-                }
-                
-                // Limite de palabras para pruebas
-                // if (total_words >= 100000) { // 
-                //     break;
-                // }
-            }
-        }
-        
-        // Limite para pruebas
-        // if (total_words >= 100000) break;
-    }
-    
-    file.close();
-    std::cout << "Total de palabras cargadas: " << total_words << std::endl;
-    return words;
-}
+#include <memory>
 
 // Funcion para simular la escritura de una palabra usando autocompletado
 struct SimulationResult {
@@ -70,80 +23,39 @@ struct SimulationResult {
     double time_taken_ms;   // Tiempo que tomó procesar esta palabra
 };
 
-SimulationResult simulate_word_typing(Trie& trie, const std::string& word) {
+// Plantilla para poder simular con Trie, RadixTrie o DoubleArrayTrie: todos
+// avanzan una tecla a la vez con su Cursor
+template <class TrieT>
+SimulationResult simulate_word_typing(TrieT& trie, std::string_view word) {
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    Trie::Node* current = trie.root_;
-    size_t chars_typed = 0;
-    bool autocomplete_success = false;
-    
-    // Primero verificar si la palabra existe en el trie
-    Trie::Node* temp = trie.root_;
-    bool word_exists = true;
+    // Una sola pasada: la sugerencia se compara por identidad de nodo. Los
+    // prefijos cuya sugerencia es la palabra forman un tramo contiguo que
+    // termina en la palabra completa, así que basta recordar dónde empezó
+    // el tramo de la sugerencia actual y, al final, ver si es el terminal.
+    typename TrieT::Cursor cursor(trie);
+    typename TrieT::Node* previous = nullptr;
+    size_t run_start = 0;
     for (char c : word) {
-        temp = trie.descend(temp, c);
-        if (!temp) {
-            word_exists = false;
-            break;
+        if (!cursor.advance(c)) break;
+        typename TrieT::Node* suggestion = cursor.suggestion();
+        if (suggestion != previous) {
+            previous = suggestion;
+            run_start = cursor.depth;
         }
     }
     
-    if (word_exists) {
-        temp = trie.descend(temp, '$');
-        word_exists = (temp && temp->str && *temp->str == word);
-    }
-    
-    if (!word_exists) {
-        // Palabra no existe en el trie, usuario debe escribirla completa
-        auto end_time = std::chrono::high_resolution_clock::now();
-        double time_ms = std::chrono::duration_cast<std::chrono::microseconds>(
-            end_time - start_time).count() / 1000.0;
-        
-        return SimulationResult{word.length(), 0, false, time_ms};
-    }
-    
-    // La palabra existe, simular escritura con autocompletado
-    for (size_t i = 0; i < word.length(); ++i) {
-        char c = word[i];
-        Trie::Node* next_node = trie.descend(current, c);
-        
-        if (!next_node) {
-            // Esto no debería pasar si word_exists es true
-            chars_typed = word.length();
-            break;
-        }
-        
-        current = next_node;
-        chars_typed++;
-        
-        // Verificar autocompletado en el nodo actual
-        Trie::Node* autocomplete_node = trie.autocomplete(current);
-        if (autocomplete_node && autocomplete_node->str) {
-            std::string completed_word = *autocomplete_node->str;
-            
-            if (completed_word == word) {
-                // Autocompletado exitoso
-                autocomplete_success = true;
-                break;
-            }
-        }
-    }
+    typename TrieT::Node* terminal = cursor.valid() ? cursor.terminal() : nullptr;
+    bool autocomplete_success = terminal && previous == terminal;
+    size_t chars_typed = autocomplete_success ? run_start : word.length();
     
     auto end_time = std::chrono::high_resolution_clock::now();
-    double time_ms = std::chrono::duration_cast<std::chrono::microseconds>(
-        end_time - start_time).count() / 1000.0;
+    double time_ms = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time).count() / 1e6;
     
-    // Actualizar prioridad de la palabra
-    Trie::Node* word_node = trie.root_;
-    for (char c : word) {
-        word_node = trie.descend(word_node, c);
-        if (!word_node) break;
-    }
-    if (word_node) {
-        word_node = trie.descend(word_node, '$');
-        if (word_node && word_node->str && *word_node->str == word) {
-            trie.update_priority(word_node);
-        }
+    // Actualizar prioridad de la palabra, si existe en el trie
+    if (terminal) {
+        trie.update_priority(terminal);
     }
     
     return SimulationResult{
@@ -154,17 +66,24 @@ SimulationResult simulate_word_typing(Trie& trie, const std::string& word) {
     };
 }
 
-// Función para ejecutar la simulación completa
-void run_simulation(Trie& trie, const std::vector<std::string>& words, 
-                   const std::string& dataset_name, const std::string& variant_name) {
+// Función para ejecutar la simulación completa. Consume las palabras de un
+// stream (Corpus::Reader o TokenStream); L es la cantidad total de palabras
+// y se necesita de antemano para fijar los milestones. Con perf, cada
+// milestone guarda además los contadores de hardware acumulados desde el
+// inicio de la simulación, divididos por las teclas procesadas
+template <class TrieT, class Stream>
+void run_simulation(TrieT& trie, Stream& words, size_t L,
+                   const std::string& dataset_name, const std::string& variant_name,
+                   const PerfCounters* perf = nullptr) {
     std::cout << "\n=== Simulación: " << dataset_name << " (" << variant_name << ") ===" << std::endl;
     
-    const size_t L = words.size();
     std::cout << "Palabras a simular: " << L << std::endl;
     
     std::vector<double> percentages;
     std::vector<double> simulation_times;
     std::vector<size_t> milestone_indices;
+    std::vector<PerfCounters::Sample> milestone_counters;
+    std::vector<size_t> milestone_keystrokes;
     
     // contaremos desde 2^0 hasta 2^21
     for (int i = 0; i <= 21; ++i) {
@@ -188,8 +107,14 @@ void run_simulation(Trie& trie, const std::vector<std::string>& words,
     std::cout << "\nProgreso de la simulación:" << std::endl;
     std::cout << "--------------------------" << std::endl;
     
-    for (size_t i = 0; i < L; ++i) {
-        const std::string& word = words[i];
+    // Los contadores siguen corriendo durante todo el ciclo (incluye leer
+    // la palabra del stream); leerlos por palabra costaría más que la
+    // palabra misma
+    PerfCounters::Sample counters_start;
+    if (perf) counters_start = perf->read();
+    
+    std::string_view word;
+    for (size_t i = 0; i < L && words.next(word); ++i) {
         total_chars_without_autocomplete += word.length();
         
         SimulationResult result = simulate_word_typing(trie, word);
@@ -211,6 +136,10 @@ void run_simulation(Trie& trie, const std::vector<std::string>& words,
                                total_chars_without_autocomplete) * 100.0;
             percentages.push_back(percentage);
             simulation_times.push_back(total_simulation_time_ms);
+            if (perf) {
+                milestone_counters.push_back(perf->read() - counters_start);
+                milestone_keystrokes.push_back(total_chars_without_autocomplete);
+            }
             
             std::cout << "Palabra " << std::setw(8) << (i + 1) << ": " 
                       << std::fixed << std::setprecision(2) << percentage 
@@ -246,53 +175,419 @@ void run_simulation(Trie& trie, const std::vector<std::string>& words,
               << (total_simulation_time_ms / L) << " ms" << std::endl;
     std::cout << "Tiempo promedio por carácter: " << std::fixed << std::setprecision(4) 
               << (total_simulation_time_ms * 1000 / total_chars_without_autocomplete) << " μs" << std::endl;
+    if (perf && !milestone_counters.empty()) {
+        PerfCounters::print_phase("simulación", milestone_counters.back(), milestone_keystrokes.back());
+    }
     
     // Export a csv
     std::string output_filename = "resultados/results_" + dataset_name + "_" + variant_name + ".csv";
     std::ofstream output_file(output_filename);
     if (output_file.is_open()) {
-        output_file << "palabras,porcentaje_caracteres,tiempo_acumulado_ms\n";
+        output_file << "palabras,porcentaje_caracteres,tiempo_acumulado_ms"
+                    << (perf ? PerfCounters::csv_header() : "") << "\n";
         for (size_t i = 0; i < percentages.size(); ++i) {
             output_file << (milestone_indices[i] + 1) << "," 
                        << std::fixed << std::setprecision(4) << percentages[i] << ","
-                       << std::fixed << std::setprecision(2) << simulation_times[i] << "\n";
+                       << std::fixed << std::setprecision(2) << simulation_times[i];
+            if (perf) PerfCounters::write_csv(output_file, milestone_counters[i], milestone_keystrokes[i]);
+            output_file << "\n";
         }
         output_file.close();
         std::cout << "Datos exportados a: " << output_filename << std::endl;
     }
 }
 
+// Simula una palabra mostrando una lista de sugerencias: cuenta como
+// autocompletada en cuanto aparece en cualquiera de las k primeras.
+// update_ns acumula el costo de update_priority (incluye mantener top-k).
+template <class TrieT>
+SimulationResult simulate_word_typing_topk(TrieT& trie, std::string_view word,
+                                           size_t k, double& update_ns) {
+    TrieTypes::Node* suggestions[255];
+    typename TrieT::Cursor cursor(trie);
+    size_t chars_typed = word.length();
+    bool autocomplete_success = false;
+    
+    // Se sigue bajando después del acierto para llegar al terminal
+    for (char c : word) {
+        if (!cursor.advance(c)) break;
+        if (autocomplete_success) continue;
+        
+        size_t n = trie.top_k(cursor.node(), k, suggestions);
+        for (size_t j = 0; j < n; ++j) {
+            if (trie.word(suggestions[j]) == word) {
+                autocomplete_success = true;
+                chars_typed = cursor.depth;
+                break;
+            }
+        }
+    }
+    
+    TrieTypes::Node* terminal = cursor.valid() ? cursor.terminal() : nullptr;
+    if (terminal) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        trie.update_priority(terminal);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        update_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+    }
+    
+    return SimulationResult{chars_typed, word.length() - chars_typed, autocomplete_success, 0};
+}
+
+// Repite la simulación con listas de k sugerencias para varios k y exporta
+// caracteres ahorrados y costo por update a resultados/topk_<dataset>_<modo>.csv
+template <class Ranking>
+void run_topk_sweep(const Corpus& words, const std::string& dataset_name, const std::string& variant_name) {
+    const size_t ks[] = {1, 2, 3, 4, 5, 8, 10};
+    
+    std::cout << "\n=== Simulación top-k: " << dataset_name << " (" << variant_name << ") ===" << std::endl;
+    std::cout << std::setw(4) << "k" << " | " << std::setw(10) << "% escritos" << " | "
+              << std::setw(10) << "Ahorrados" << " | " << std::setw(12) << "ns/update" << " | "
+              << std::setw(10) << "KB top-k" << std::endl;
+    
+    std::string output_filename = "resultados/topk_" + dataset_name + "_" + variant_name + ".csv";
+    std::ofstream output_file(output_filename);
+    if (output_file.is_open()) {
+        output_file << "k,porcentaje_caracteres,caracteres_ahorrados,autocompletados,ns_por_update,bytes_topk\n";
+    }
+    
+    for (size_t k : ks) {
+        Trie<Ranking> trie(k);
+        for (std::string_view w : words) trie.insert(w);
+        
+        size_t total_chars = 0, written = 0, successes = 0, updates = 0;
+        double update_ns = 0;
+        for (std::string_view w : words) {
+            double before = update_ns;
+            SimulationResult result = simulate_word_typing_topk(trie, w, k, update_ns);
+            total_chars += w.length();
+            written += result.chars_written;
+            if (result.success) successes++;
+            if (update_ns != before) updates++;
+        }
+        
+        double percentage = static_cast<double>(written) / total_chars * 100.0;
+        double ns_per_update = updates ? update_ns / updates : 0;
+        std::cout << std::setw(4) << k << " | " 
+                  << std::setw(10) << std::fixed << std::setprecision(2) << percentage << " | "
+                  << std::setw(10) << (total_chars - written) << " | "
+                  << std::setw(12) << std::fixed << std::setprecision(1) << ns_per_update << " | "
+                  << std::setw(10) << trie.topk_bytes() / 1024 << std::endl;
+        if (output_file.is_open()) {
+            output_file << k << "," << std::fixed << std::setprecision(4) << percentage << ","
+                        << (total_chars - written) << "," << successes << ","
+                        << std::fixed << std::setprecision(1) << ns_per_update << ","
+                        << trie.topk_bytes() << "\n";
+        }
+    }
+    
+    if (output_file.is_open()) {
+        std::cout << "Datos exportados a: " << output_filename << std::endl;
+    }
+}
+
+// Sesión en línea con presupuesto de memoria: el trie parte vacío, cada
+// palabra se escribe con lo que el trie ya sabe y después se inserta (o se
+// usa, si estaba). Se corre sin límite y con fracciones de la memoria
+// máxima de esa corrida; el trie desaloja las palabras usadas hace más
+// tiempo. Exporta caracteres ahorrados contra memoria a
+// resultados/budget_<dataset>_<modo>.csv
+template <class Ranking>
+void run_budget_sweep(const Corpus& words, const std::string& dataset_name, const std::string& variant_name) {
+    const size_t fractions[] = {0, 2, 4, 8, 16, 32, 64};   // presupuesto = máximo sin límite / f
+    
+    std::cout << "\n=== Simulación con presupuesto: " << dataset_name << " (" << variant_name << ") ===" << std::endl;
+    std::cout << std::setw(14) << "Presupuesto KB" << " | " << std::setw(10) << "% escritos" << " | "
+              << std::setw(10) << "Ahorrados" << " | " << std::setw(8) << "Vivas" << " | "
+              << std::setw(10) << "Desalojos" << " | " << std::setw(10) << "Máximo KB" << " | "
+              << std::setw(11) << "Reservado KB" << " | " << std::setw(8) << "ns/pal" << std::endl;
+    
+    std::string output_filename = "resultados/budget_" + dataset_name + "_" + variant_name + ".csv";
+    std::ofstream output_file(output_filename);
+    if (output_file.is_open()) {
+        output_file << "presupuesto_bytes,porcentaje_caracteres,caracteres_ahorrados,autocompletados,"
+                       "palabras_vivas,desalojos,bytes_maximo,bytes_reservados,ns_por_palabra\n";
+    }
+    
+    size_t unlimited_peak = 0;
+    for (size_t f : fractions) {
+        size_t budget = f ? std::max<size_t>(1, unlimited_peak / f) : 0;
+        Trie<Ranking> trie;
+        trie.set_budget(budget, 0);
+        
+        size_t total_chars = 0, written = 0, successes = 0, peak = 0;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (std::string_view w : words) {
+            SimulationResult result = simulate_word_typing(trie, w);
+            total_chars += w.length();
+            written += result.chars_written;
+            if (result.success) successes++;
+            
+            // Palabra nueva: entra con su primer uso, igual que las demás
+            size_t seen = trie.live_words() + trie.evictions();
+            TrieTypes::Node* terminal = trie.insert(w);
+            if (terminal && trie.live_words() + trie.evictions() != seen) trie.update_priority(terminal);
+            peak = std::max(peak, trie.approx_memory_bytes());
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        if (!f) unlimited_peak = peak;
+        
+        double percentage = static_cast<double>(written) / total_chars * 100.0;
+        double ns_per_word = std::chrono::duration<double, std::nano>(end_time - start_time).count() / words.size();
+        std::cout << std::setw(14) << (f ? std::to_string(budget / 1024) : "sin límite") << " | "
+                  << std::setw(10) << std::fixed << std::setprecision(2) << percentage << " | "
+                  << std::setw(10) << (total_chars - written) << " | " << std::setw(8) << trie.live_words() << " | "
+                  << std::setw(10) << trie.evictions() << " | " << std::setw(10) << peak / 1024 << " | "
+                  << std::setw(11) << trie.arena_bytes() / 1024 << " | "
+                  << std::setw(8) << std::setprecision(0) << ns_per_word << std::endl;
+        if (output_file.is_open()) {
+            output_file << budget << "," << std::fixed << std::setprecision(4) << percentage << ","
+                        << (total_chars - written) << "," << successes << "," << trie.live_words() << ","
+                        << trie.evictions() << "," << peak << "," << trie.arena_bytes() << ","
+                        << std::setprecision(1) << ns_per_word << "\n";
+        }
+    }
+    
+    if (output_file.is_open()) {
+        std::cout << "Datos exportados a: " << output_filename << std::endl;
+    }
+}
+
+// Modo frecuente con ventana deslizante de n palabras para varios n (0 es
+// sin ventana, la frecuencia de siempre): el trie se construye con todas
+// las palabras y la simulación cuenta solo los últimos n usos. Exporta
+// caracteres ahorrados y costo por palabra (escribirla, subir la que entra
+// y bajar la que sale) a resultados/window_<dataset>.csv
+void run_window_sweep(const Corpus& words, const std::string& dataset_name) {
+    const size_t windows[] = {0, 16, 64, 256, 1024, 4096, 16384, 65536, 262144};
+    
+    std::cout << "\n=== Simulación con ventana deslizante: " << dataset_name << " (frecuente) ===" << std::endl;
+    std::cout << std::setw(8) << "Ventana" << " | " << std::setw(10) << "% escritos" << " | "
+              << std::setw(10) << "Ahorrados" << " | " << std::setw(10) << "KB ventana" << " | "
+              << std::setw(8) << "ns/pal" << std::endl;
+    
+    std::string output_filename = "resultados/window_" + dataset_name + ".csv";
+    std::ofstream output_file(output_filename);
+    if (output_file.is_open()) {
+        output_file << "ventana,porcentaje_caracteres,caracteres_ahorrados,autocompletados,bytes_ventana,ns_por_palabra\n";
+    }
+    
+    for (size_t n : windows) {
+        Trie<FrequentRanking> trie;
+        for (std::string_view w : words) trie.insert(w);
+        trie.set_window(n);
+        
+        size_t total_chars = 0, written = 0, successes = 0;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (std::string_view w : words) {
+            SimulationResult result = simulate_word_typing(trie, w);
+            total_chars += w.length();
+            written += result.chars_written;
+            if (result.success) successes++;
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        
+        double percentage = static_cast<double>(written) / total_chars * 100.0;
+        double ns_per_word = std::chrono::duration<double, std::nano>(end_time - start_time).count() / words.size();
+        std::cout << std::setw(8) << (n ? std::to_string(n) : "sin") << " | "
+                  << std::setw(10) << std::fixed << std::setprecision(2) << percentage << " | "
+                  << std::setw(10) << (total_chars - written) << " | "
+                  << std::setw(10) << trie.window_bytes() / 1024 << " | "
+                  << std::setw(8) << std::setprecision(0) << ns_per_word << std::endl;
+        if (output_file.is_open()) {
+            output_file << n << "," << std::fixed << std::setprecision(4) << percentage << ","
+                        << (total_chars - written) << "," << successes << "," << trie.window_bytes() << ","
+                        << std::setprecision(1) << ns_per_word << "\n";
+        }
+    }
+    
+    if (output_file.is_open()) {
+        std::cout << "Datos exportados a: " << output_filename << std::endl;
+    }
+}
+
+// Búsqueda exacta de todas las palabras sin tocar prioridades: separa el
+// costo de bajar por el trie del de update_priority. Solo se usa con perf
+template <class TrieT, class Stream>
+void measure_lookups(TrieT& trie, Stream& words, const PerfCounters& perf) {
+    size_t found = 0, keystrokes = 0;
+    PerfCounters::Sample before = perf.read();
+    std::string_view w;
+    while (words.next(w)) {
+        typename TrieT::Cursor cursor(trie);
+        for (char c : w)
+            if (!cursor.advance(c)) break;
+        found += cursor.valid() && cursor.terminal();
+        keystrokes += w.length();
+    }
+    PerfCounters::Sample after = perf.read();
+    std::cout << "Búsquedas exactas: " << found << "/" << words.count() << " encontradas" << std::endl;
+    PerfCounters::print_phase("búsqueda", after - before, keystrokes);
+}
+
+// Construye el trie con una pasada sobre el stream, lo rebobina y simula
+// con una segunda pasada. Con perf mide además construcción y búsqueda
+// (una pasada extra de solo lectura antes de simular)
+template <class TrieT, class Stream>
+void build_and_simulate(TrieT& trie, Stream& simulation_words,
+                        const std::string& dataset_name, const std::string& variant_name,
+                        const PerfCounters* perf = nullptr) {
+    std::cout << "\nConstruyendo trie con todas las palabras..." << std::endl;
+    
+    size_t build_keystrokes = 0;
+    PerfCounters::Sample build_counters;
+    if (perf) build_counters = perf->read();
+    auto build_start_time = std::chrono::high_resolution_clock::now();
+    std::string_view w;
+    while (simulation_words.next(w)) {
+        trie.insert(w);
+        build_keystrokes += w.length();
+        if (simulation_words.count() % 100000 == 0) {
+            std::cout << "Insertadas " << simulation_words.count() << " palabras..." << std::endl;
+        }
+    }
+    auto build_end_time = std::chrono::high_resolution_clock::now();
+    auto build_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        build_end_time - build_start_time);
+    
+    std::cout << "Trie construido en " << build_duration.count() << " ms" << std::endl;
+    if (perf) PerfCounters::print_phase("construcción", perf->read() - build_counters, build_keystrokes);
+    trie.print_stats();
+    
+    size_t L = simulation_words.count();
+    if (perf) {
+        simulation_words.rewind();
+        measure_lookups(trie, simulation_words, *perf);
+    }
+    
+    // Ejecutar simulación
+    simulation_words.rewind();
+    run_simulation(trie, simulation_words, L, dataset_name, variant_name, perf);
+    std::cout << "Peak RSS: " << peak_rss_kb() << " KB" << std::endl;
+}
+
+// Elige el trie (normal, radix o doble arreglo) para un stream de palabras
+template <class Stream>
+void simulate_stream(Stream& words, TrieTypes::Variant variant, const std::string& backend,
+                     const std::string& dataset_name, const std::string& mode_str,
+                     const PerfCounters* perf) {
+    if (backend == "radix") {
+        RadixTrie trie(variant);
+        build_and_simulate(trie, words, dataset_name, mode_str + "-radix", perf);
+    } else if (backend == "doble") {
+        DoubleArrayTrie trie(variant);
+        build_and_simulate(trie, words, dataset_name, mode_str + "-doble", perf);
+    } else {
+        // El modo se resuelve acá una vez: la simulación entera queda
+        // instanciada con la política de ranking
+        with_ranking(variant, [&](auto ranking) {
+            Trie<decltype(ranking)> trie;
+            build_and_simulate(trie, words, dataset_name, mode_str, perf);
+        });
+    }
+}
+
 // Función principal
 int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        std::cout << "Uso: ./simulation <dataset.txt> <modo> <nombre_dataset>\n";
+    if (argc < 4) {
+        std::cout << "Uso: ./simulation <dataset.txt> <modo> <nombre_dataset> [radix|doble] [topk] [stream] [perf] [presupuesto] [ventana]\n";
         std::cout << "  dataset.txt: archivo con texto para extraer palabras\n";
-        std::cout << "  modo: 'reciente' o 'frecuente'\n";
+        std::cout << "  modo: 'reciente', 'frecuente' o 'decaimiento' (frecuencia con decaimiento exponencial)\n";
         std::cout << "  nombre_dataset: nombre para identificar el dataset\n";
+        std::cout << "  radix: usar el trie comprimido (RadixTrie)\n";
+        std::cout << "  doble: usar el trie de doble arreglo BASE/CHECK (DoubleArrayTrie)\n";
+        std::cout << "  topk: simular listas de k sugerencias para varios k\n";
+        std::cout << "  stream: leer el archivo por bloques de tamaño fijo en vez de cargarlo entero\n";
+        std::cout << "  perf: medir contadores de hardware (ciclos, fallos de caché/TLB/saltos) por tecla\n";
+        std::cout << "  presupuesto: sesión en línea con memoria acotada (desaloja las menos usadas recientemente)\n";
+        std::cout << "  ventana: modo frecuente contando solo las últimas n palabras, para varios n\n";
+        std::cout << "  (topk, presupuesto y ventana van de a una, con el trie normal, sin stream ni perf)\n";
         std::cout << "Ejemplos:\n";
         std::cout << "  ./simulation wikipedia.txt reciente wikipedia\n";
         std::cout << "  ./simulation random.txt frecuente random\n";
+        std::cout << "  ./simulation wikipedia.txt frecuente wikipedia stream\n";
+        std::cout << "  ./simulation wikipedia.txt reciente wikipedia doble\n";
         return 1;
     }
     
     std::string filename = argv[1];
     std::string mode_str = argv[2];
     std::string dataset_name = argv[3];
+    std::string backend = "trie";
+    bool use_topk = false, use_stream = false, use_perf = false, use_budget = false, use_window = false;
+    for (int i = 4; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "radix" || option == "doble") backend = option;
+        else if (option == "topk") use_topk = true;
+        else if (option == "stream") use_stream = true;
+        else if (option == "perf") use_perf = true;
+        else if (option == "presupuesto") use_budget = true;
+        else if (option == "ventana") use_window = true;
+        else {
+            std::cerr << "Error: Opción desconocida '" << option << "'" << std::endl;
+            return 1;
+        }
+    }
     
     // Validar modo
-    Trie::Variant variant;
+    TrieTypes::Variant variant;
     if (mode_str == "reciente") {
-        variant = Trie::Variant::MOST_RECENT;
+        variant = TrieTypes::Variant::MOST_RECENT;
     } else if (mode_str == "frecuente") {
-        variant = Trie::Variant::MOST_FREQUENT;
+        variant = TrieTypes::Variant::MOST_FREQUENT;
+    } else if (mode_str == "decaimiento") {
+        variant = TrieTypes::Variant::DECAYED;
     } else {
-        std::cerr << "Error: Modo debe ser 'reciente' o 'frecuente'" << std::endl;
+        std::cerr << "Error: Modo debe ser 'reciente', 'frecuente' o 'decaimiento'" << std::endl;
+        return 1;
+    }
+    if (variant == TrieTypes::Variant::DECAYED && backend != "trie") {
+        std::cerr << "Error: 'decaimiento' solo está implementado en el trie normal" << std::endl;
+        return 1;
+    }
+    if (use_window && variant != TrieTypes::Variant::MOST_FREQUENT) {
+        std::cerr << "Error: 'ventana' solo se aplica al modo frecuente" << std::endl;
+        return 1;
+    }
+    
+    // topk, presupuesto y ventana son barridos sobre el trie normal con el
+    // corpus cargado entero: no se combinan entre sí ni con otro backend,
+    // stream o perf
+    int sweeps = use_topk + use_budget + use_window;
+    if (sweeps > 1) {
+        std::cerr << "Error: 'topk', 'presupuesto' y 'ventana' no se combinan entre sí" << std::endl;
+        return 1;
+    }
+    if (sweeps && (backend != "trie" || use_stream || use_perf)) {
+        std::cerr << "Error: 'topk', 'presupuesto' y 'ventana' solo corren con el trie normal, "
+                     "sin 'radix', 'doble', 'stream' ni 'perf'" << std::endl;
         return 1;
     }
     
+    // Los contadores se abren antes de cargar para que la construcción y la
+    // simulación se lean como restas; sin "perf" no se abre nada
+    std::unique_ptr<PerfCounters> perf;
+    if (use_perf) {
+        perf = std::make_unique<PerfCounters>();
+        perf->print_status();
+    }
+    
+    // Streaming: memoria acotada por el trie más un buffer fijo
+    if (use_stream) {
+        TokenStream stream(Corpus::Split::WHITESPACE, 1);
+        if (!stream.open(filename)) {
+            std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
+            return 1;
+        }
+        std::cout << "Leyendo " << filename << " en streaming (buffer de "
+                  << stream.buffer_bytes() / 1024 << " KB)" << std::endl;
+        simulate_stream(stream, variant, backend, dataset_name, mode_str, perf.get());
+        return 0;
+    }
+    
     // Cargar palabras para simulación
     auto start_time = std::chrono::high_resolution_clock::now();
-    std::vector<std::string> simulation_words = load_words_from_file(filename);
+    Corpus simulation_words = load_corpus(filename, Corpus::Split::WHITESPACE);
     auto end_time = std::chrono::high_resolution_clock::now();
     
     if (simulation_words.empty()) {
@@ -303,26 +598,20 @@ int main(int argc, char* argv[]) {
     auto load_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     std::cout << "Tiempo de carga: " << load_duration.count() << " ms" << std::endl;
     
-    // Primero construir el trie con todas las palabras
-    std::cout << "\nConstruyendo trie con todas las palabras..." << std::endl;
-    Trie trie(variant);
-    
-    auto build_start_time = std::chrono::high_resolution_clock::now();
-    for (size_t i = 0; i < simulation_words.size(); ++i) {
-        trie.insert(simulation_words[i]);
-        if ((i + 1) % 100000 == 0) {
-            std::cout << "Insertadas " << (i + 1) << " palabras..." << std::endl;
-        }
+    if (use_window) {
+        run_window_sweep(simulation_words, dataset_name);
+    } else if (use_budget) {
+        with_ranking(variant, [&](auto ranking) {
+            run_budget_sweep<decltype(ranking)>(simulation_words, dataset_name, mode_str);
+        });
+    } else if (use_topk) {
+        with_ranking(variant, [&](auto ranking) {
+            run_topk_sweep<decltype(ranking)>(simulation_words, dataset_name, mode_str);
+        });
+    } else {
+        Corpus::Reader reader(simulation_words);
+        simulate_stream(reader, variant, backend, dataset_name, mode_str, perf.get());
     }
-    auto build_end_time = std::chrono::high_resolution_clock::now();
-    auto build_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        build_end_time - build_start_time);
-    
-    std::cout << "Trie construido en " << build_duration.count() << " ms" << std::endl;
-    trie.print_stats();
-    
-    // Ejecutar simulación
-    run_simulation(trie, simulation_words, dataset_name, mode_str);
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "trie.cpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Pruebas de invariantes del trie que no necesitan un corpus: se arman con
+// palabras al azar. make test las compila y corre; sale con 1 si alguna falla.
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FALLA: " << what << std::endl;
+        ++failures;
+    }
+}
+
+static std::vector<std::string> random_words(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> words;
+    for (size_t i = 0; i < n; ++i) {
+        std::string w;
+        size_t len = 1 + rng() % 6;
+        for (size_t j = 0; j < len; ++j) w += static_cast<char>('a' + rng() % 5);
+        words.push_back(w);
+    }
+    return words;
+}
+
+// Cada nodo del árbol tiene como mejor a un terminal vivo de su subárbol
+// con la prioridad máxima de ese subárbol; los nodos de la arena que no
+// están en el árbol no tienen mejor
+template <class TrieT>
+static bool best_is_consistent(const TrieT& t) {
+    std::vector<char> in_tree(t.nodes_.size(), 0);
+    std::vector<const TrieTypes::Node*> order = {t.root()};
+    for (size_t i = 0; i < order.size(); ++i) {
+        const TrieTypes::Node* u = order[i];
+        in_tree[u->id] = 1;
+        t.blocks_.for_each_child(u, [&](int, TrieTypes::Id c) { order.push_back(t.node(c)); });
+    }
+    for (TrieTypes::Id i = 0; i < t.nodes_.size(); ++i) {
+        const TrieTypes::Node& u = t.nodes_[i];
+        if (!in_tree[i] && u.best_terminal() != TrieTypes::NONE) return false;
+    }
+
+    // Máximo de cada subárbol, de las hojas hacia la raíz
+    std::vector<int64_t> max_priority(t.nodes_.size(), -1);
+    for (size_t i = order.size(); i-- > 0;) {
+        const TrieTypes::Node* u = order[i];
+        if (u->is_terminal()) max_priority[u->id] = u->priority;
+        if (u->parent != TrieTypes::NONE)
+            max_priority[u->parent] = std::max(max_priority[u->parent], max_priority[u->id]);
+    }
+    for (const TrieTypes::Node* u : order) {
+        TrieTypes::Id b = u->best_terminal();
+        if (max_priority[u->id] < 0) continue;
+        if (b == TrieTypes::NONE || !in_tree[b] || !t.node(b)->is_terminal()) return false;
+        if (u->best_priority() != max_priority[u->id] || t.node(b)->priority != max_priority[u->id]) return false;
+        const TrieTypes::Node* a = t.node(b);
+        while (a && a != u) a = t.node(a->parent);
+        if (a != u) return false;
+    }
+    return true;
+}
+
+// build_parallel deja la arena y las listas top-k del mismo tamaño que
+// insertar en orden (sin huecos entre shards), y reescalar después, que
+// recorre toda la arena, mantiene los mejores
+template <class Ranking>
+static void test_parallel_build_rescale() {
+    std::vector<std::string> words = random_words(3000, 11);
+    std::vector<std::string_view> views(words.begin(), words.end());
+    Trie<Ranking> sequential(5), trie(5);
+    for (std::string_view w : views) sequential.insert(w);
+    trie.build_parallel(views, 4);
+    check(trie.nodes_.size() == sequential.nodes_.size() && trie.topk_bytes() == sequential.topk_bytes(),
+          std::string("build_parallel sin huecos en la arena (") + Ranking::NAME + ")");
+    check(best_is_consistent(trie), std::string("build_parallel (") + Ranking::NAME + ")");
+
+    std::mt19937 rng(5);
+    for (int i = 0; i < 2000; ++i) trie.update_priority(trie.insert(views[rng() % views.size()]));
+    trie.rescale_priorities(1);
+    check(best_is_consistent(trie), std::string("build_parallel + rescale_priorities (") + Ranking::NAME + ")");
+    if constexpr (!Trie<Ranking>::RESCALES) {
+        trie.renormalize_priorities();
+        check(best_is_consistent(trie), std::string("build_parallel + renormalize_priorities (") + Ranking::NAME + ")");
+    }
+}
+
+// Pasar MAX_PRIORITY en update_priority renormaliza sin romper el orden:
+// en reciente el último usado sigue siendo el mejor de la raíz y el reloj
+// avanza uno por uso; en frecuente la palabra más usada sigue ganando
+static void test_priority_overflow() {
+    std::vector<std::string> words = random_words(400, 9);
+    std::mt19937 rng(2);
+
+    Trie<RecentRanking> recent;
+    for (const std::string& w : words) recent.insert(w);
+    for (int i = 0; i < 300; ++i) recent.update_priority(recent.insert(words[rng() % words.size()]));
+    const int64_t shift = TrieTypes::MAX_PRIORITY - 1000;
+    for (TrieTypes::Id i = 0; i < recent.nodes_.size(); ++i) {
+        TrieTypes::Node& u = recent.nodes_[i];
+        if (u.is_terminal() && u.priority > 0) u.priority += shift;
+    }
+    recent.access_counter_ += shift;
+    recent.refresh_best_priorities();
+    bool last_wins = true, clock_steps = true;
+    for (int i = 0; i < 2000; ++i) {
+        int64_t before = recent.access_counter_;
+        TrieTypes::Node* t = recent.insert(words[rng() % words.size()]);
+        recent.update_priority(t);
+        last_wins = last_wins && recent.root()->best_terminal() == t->id && t->priority == recent.access_counter_;
+        clock_steps = clock_steps && (recent.access_counter_ == before + 1 || recent.access_counter_ < before);
+    }
+    check(recent.access_counter_ < 2000 + static_cast<int64_t>(words.size()), "reciente renormaliza el reloj");
+    check(last_wins, "reciente: el último usado gana tras renormalizar");
+    check(clock_steps, "reciente: el reloj avanza uno por uso");
+    check(best_is_consistent(recent), "reciente: mejores tras renormalizar");
+
+    Trie<FrequentRanking> frequent;
+    for (const std::string& w : words) frequent.insert(w);
+    for (int i = 0; i < 300; ++i) frequent.update_priority(frequent.insert(words[rng() % words.size()]));
+    TrieTypes::Node* top = frequent.insert(words[0]);
+    top->priority = TrieTypes::MAX_PRIORITY;
+    frequent.update_priority(top);
+    check(top->priority == TrieTypes::MAX_PRIORITY / 2 + 1, "frecuente: se divide por 2 y suma el uso");
+    check(frequent.root()->best_terminal() == top->id, "frecuente: la más usada sigue ganando");
+    check(best_is_consistent(frequent), "frecuente: mejores tras renormalizar");
+}
+
+// Un trie con presupuesto que se vacía con reset() o se reemplaza con
+// open() queda sin presupuesto (la lista LRU no sobrevive) y al fijarlo de
+// nuevo vuelve a respetarlo
+static void test_budget_reset_open() {
+    const char* path = "test_trie.tmp";
+    std::vector<std::string> words = random_words(2000, 3);
+    Trie<RecentRanking> plain;
+    for (const std::string& w : words) plain.insert(w);
+    check(plain.save(path), "guardar snapshot sin presupuesto");
+
+    Trie<RecentRanking> trie;
+    trie.set_budget(0, 50);
+    for (const std::string& w : words) trie.insert(w);
+    check(trie.live_words() <= 50, "presupuesto respetado al insertar");
+
+    trie.reset();
+    check(!trie.budgeted(), "reset() quita el presupuesto");
+    check(trie.open(path), "abrir snapshot");
+    check(!trie.budgeted(), "open() deja el trie sin presupuesto");
+    check(trie.live_words() == plain.live_words(), "open() trae todas las palabras");
+    trie.set_budget(0, 50);
+    for (const std::string& w : random_words(500, 4)) trie.insert(w);
+    check(trie.live_words() <= 50, "presupuesto respetado tras open()");
+    check(best_is_consistent(trie), "mejores tras desalojar en un snapshot abierto");
+    std::remove(path);
+}
+
+// Lo mismo con la ventana deslizante: después de open() el trie no tiene
+// ventana, y al fijarla de nuevo las prioridades cargadas vuelven a 0 y
+// cuentan solo los usos de la ventana
+static void test_window_reset_open() {
+    const char* path = "test_trie.tmp";
+    std::vector<std::string> words = random_words(500, 7);
+    Trie<FrequentRanking> plain;
+    for (const std::string& w : words) plain.update_priority(plain.insert(w));
+    check(plain.save(path), "guardar snapshot con prioridades");
+
+    Trie<FrequentRanking> trie;
+    trie.set_window(10);
+    trie.reset();
+    check(trie.window() == 0, "reset() quita la ventana");
+    trie.set_window(10);
+    check(trie.open(path), "abrir snapshot");
+    check(trie.window() == 0, "open() deja el trie sin ventana");
+
+    const size_t n = 20;
+    trie.set_window(n);
+    std::vector<std::string> recent = random_words(300, 8);
+    for (const std::string& w : recent) trie.update_priority(trie.insert(w));
+    int64_t total = 0;
+    for (TrieTypes::Id i = 0; i < trie.nodes_.size(); ++i) {
+        const TrieTypes::Node& u = trie.nodes_[i];
+        if (trie.is_live(u) && u.is_terminal()) total += u.priority;
+    }
+    check(total == static_cast<int64_t>(n), "tras open() y set_window las prioridades suman la ventana");
+    check(best_is_consistent(trie), "mejores con ventana en un snapshot abierto");
+    std::remove(path);
+}
+
+// Un snapshot con el encabezado bien pero con offsets o conteos que se
+// salen del archivo no se abre, y el trie queda como estaba
+static void test_open_corrupt_sections() {
+    typedef Trie<RecentRanking> T;
+    const char* path = "test_trie.tmp";
+    std::vector<std::string> words = random_words(2000, 13);
+    T saved;
+    for (const std::string& w : words) saved.insert(w);
+    check(saved.save(path), "guardar snapshot para corromper");
+    std::string good;
+    {
+        std::ifstream in(path, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    auto open_with = [&](void (*corrupt)(T::SnapshotHeader&)) {
+        T::SnapshotHeader h;
+        std::memcpy(&h, good.data(), sizeof h);
+        corrupt(h);
+        std::string bytes = good;
+        std::memcpy(&bytes[0], &h, sizeof h);
+        std::ofstream(path, std::ios::binary).write(bytes.data(), bytes.size());
+        T trie;
+        trie.insert("hola");
+        bool opened = trie.open(path);
+        check(opened || trie.live_words() == 1, "un open() fallido no toca el trie");
+        return opened;
+    };
+    check(!open_with([](T::SnapshotHeader& h) { h.chars_at = h.file_bytes; }), "chars_at al final del archivo");
+    check(!open_with([](T::SnapshotHeader& h) { h.refs_at = h.chars_at + T::SNAPSHOT_ALIGN; }), "secciones fuera de orden");
+    check(!open_with([](T::SnapshotHeader& h) { h.topk_size = ~uint64_t(0) / 2; }), "conteo que desborda");
+    check(!open_with([](T::SnapshotHeader& h) { h.slots_at += 1; }), "sección sin alinear");
+    check(!open_with([](T::SnapshotHeader& h) { h.root = static_cast<uint32_t>(h.nodes_size); }), "raíz fuera de los nodos");
+    check(open_with([](T::SnapshotHeader&) {}), "el snapshot sano se abre");
+    std::remove(path);
+}
+
+// El límite de largo cuenta letras ya normalizadas: una palabra de
+// MAX_LENGTH letras con signos alrededor entra, una letra más no
+static void test_max_length_normalized() {
+    Trie<RecentRanking> trie;
+    std::string longest(WordPool::MAX_LENGTH, 'a');
+    check(trie.insert("\"" + longest + "\"...") != nullptr, "MAX_LENGTH letras con signos se inserta");
+    check(trie.insert(longest + "b") == nullptr, "MAX_LENGTH + 1 letras no se inserta");
+    check(trie.word_count() == 1, "solo queda la palabra que cabe");
+}
+
+int main() {
+    test_parallel_build_rescale<RecentRanking>();
+    test_parallel_build_rescale<FrequentRanking>();
+    test_parallel_build_rescale<DecayedRanking<>>();
+    test_priority_overflow();
+    test_budget_reset_open();
+    test_window_reset_open();
+    test_open_corrupt_sections();
+    test_max_length_normalized();
+
+    if (failures) {
+        std::cerr << failures << " pruebas fallaron" << std::endl;
+        return 1;
+    }
+    std::cout << "Pruebas del trie: todo bien" << std::endl;
+    return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Pool mínimo para trabajos independientes: cada hilo toma el siguiente
+// índice libre de un contador atómico hasta agotar los n trabajos.
+
+// Hilos a usar para n trabajos: los núcleos disponibles, sin pasarse de n
+inline size_t default_thread_count(size_t jobs) {
+    size_t cores = std::thread::hardware_concurrency();
+    if (cores == 0) cores = 1;
+    return std::max<size_t>(1, std::min(cores, jobs));
+}
+
+// Ejecuta fn(i) para i en [0, n) repartido en `threads` hilos
+template <class F>
+void parallel_for(size_t n, size_t threads, F fn) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < n; i = next++) fn(i);
+    };
+    if (threads <= 1) {
+        worker();
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& th : pool) th.join();
+}
@@ -0,0 +1,301 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TOKENIZER_X86 1
+#endif
+
+#include "alphabet.cpp"
+
+// Tokenizador compartido por Corpus y TokenStream. Normaliza igual que
+// std::isalpha/std::tolower en el locale "C": se quedan solo las letras
+// ASCII, en minúscula, y las palabras se cortan en '\n' (LINES) o en
+// cualquier espacio ASCII (WHITESPACE).
+//
+// El texto se recorre en bloques de 64 bytes. Un kernel (AVX2, SSE2 o
+// escalar, elegido una vez según la CPU) clasifica el bloque en máscaras
+// de letras y separadores; si no hay otros bytes, el bloque se copia en
+// minúscula de una vez (c | 0x20) y los tokens salen de los bits de la
+// máscara de separadores. En los bloques con puntuación, dígitos o bytes
+// no ASCII solo se recorren los bits de las máscaras. La cola de menos de
+// 64 bytes va byte a byte.
+//
+// Con un alfabeto UTF8 (ver alphabet.cpp) el recorrido también decodifica
+// las letras Latin-1 escritas en UTF-8 (0xC3 0x80..0xBF) a un byte, con
+// Alphabet::fold_latin1: desde el primer byte no ASCII de un bloque el
+// resto del bloque va byte a byte. Los bloques ASCII no cambian.
+
+struct Tokenizer {
+    static const size_t BLOCK = 64;
+
+    struct Masks {
+        uint64_t letters;
+        uint64_t separators;
+        uint64_t high;                 // bytes >= 0x80
+    };
+
+    struct Kernel {
+        const char* name;
+        Masks (*classify)(const char* p, bool whitespace);   // 64 bytes
+        void (*fold)(char* dst, const char* src);            // 64 bytes, dst <= src
+    };
+
+    // --------------------------------------------------------
+    // Clasificación por byte (misma regla que los kernels)
+    // --------------------------------------------------------
+    static bool is_letter(unsigned char c) { return static_cast<unsigned char>((c | 0x20) - 'a') < 26; }
+    static bool is_separator(unsigned char c, bool whitespace) {
+        return c == '\n' || (whitespace && (c == ' ' || (c >= '\t' && c <= '\r')));
+    }
+    static char fold_letter(unsigned char c) { return static_cast<char>(c | 0x20); }
+
+    // true si w ya está normalizada (solo letras del alfabeto, en minúscula)
+    template <class Alphabet = AsciiAlphabet>
+    static bool is_normalized(std::string_view w) {
+        if constexpr (!Alphabet::UTF8) {
+            for (char c : w)
+                if (static_cast<unsigned char>(c - 'a') >= 26) return false;
+        } else {
+            for (char c : w) {
+                int k = Alphabet::INDEX[static_cast<unsigned char>(c)];
+                if (k < 0 || k >= Alphabet::LETTERS || Alphabet::SYMBOLS[k] != static_cast<unsigned char>(c))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Letras de w normalizadas (igual que al cargar un corpus, pero sin
+    // cortar en separadores): para palabras sueltas que no vienen de Corpus
+    template <class Alphabet = AsciiAlphabet>
+    static std::string normalize_word(std::string_view w) {
+        std::string s;
+        s.reserve(w.size());
+        for (size_t i = 0; i < w.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(w[i]);
+            if (is_letter(c)) {
+                s.push_back(fold_letter(c));
+            } else if (Alphabet::UTF8 && c == 0xC3 && i + 1 < w.size() && (w[i + 1] & 0xC0) == 0x80) {
+                unsigned char f = Alphabet::fold_latin1(static_cast<unsigned char>(w[++i]) + 0x40);
+                if (f) s.push_back(static_cast<char>(f));
+            }
+        }
+        return s;
+    }
+
+    // --------------------------------------------------------
+    // Kernels
+    // --------------------------------------------------------
+    static Masks classify_scalar(const char* p, bool whitespace) {
+        Masks m{0, 0, 0};
+        for (size_t j = 0; j < BLOCK; ++j) {
+            unsigned char c = static_cast<unsigned char>(p[j]);
+            if (is_letter(c)) m.letters |= 1ull << j;
+            else if (is_separator(c, whitespace)) m.separators |= 1ull << j;
+            else if (c >= 0x80) m.high |= 1ull << j;
+        }
+        return m;
+    }
+
+    static void fold_scalar(char* dst, const char* src) {
+        char tmp[BLOCK];
+        for (size_t j = 0; j < BLOCK; ++j) tmp[j] = static_cast<char>(src[j] | 0x20);
+        std::memcpy(dst, tmp, BLOCK);
+    }
+
+#ifdef TOKENIZER_X86
+    // Letra: (c | 0x20) en ['a', 'z'] con comparación con signo, así los
+    // bytes >= 0x80 (negativos) nunca cuentan
+    static Masks classify_sse2(const char* p, bool whitespace) {
+        const __m128i lo = _mm_set1_epi8('a' - 1), hi = _mm_set1_epi8('z' + 1), bit = _mm_set1_epi8(0x20);
+        const __m128i nl = _mm_set1_epi8('\n'), sp = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t' - 1), cr = _mm_set1_epi8('\r' + 1);
+        Masks m{0, 0, 0};
+        for (int k = 0; k < 4; ++k) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+            __m128i f = _mm_or_si128(v, bit);
+            __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(f, lo), _mm_cmplt_epi8(f, hi));
+            __m128i sep = _mm_cmpeq_epi8(v, nl);
+            if (whitespace) {
+                sep = _mm_or_si128(sep, _mm_cmpeq_epi8(v, sp));
+                sep = _mm_or_si128(sep, _mm_and_si128(_mm_cmpgt_epi8(v, tab), _mm_cmplt_epi8(v, cr)));
+            }
+            m.letters |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(letter))) << (16 * k);
+            m.separators |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(sep))) << (16 * k);
+            m.high |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(v))) << (16 * k);
+        }
+        return m;
+    }
+
+    static void fold_sse2(char* dst, const char* src) {
+        const __m128i bit = _mm_set1_epi8(0x20);
+        __m128i v[4];
+        for (int k = 0; k < 4; ++k) v[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16 * k));
+        for (int k = 0; k < 4; ++k) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16 * k), _mm_or_si128(v[k], bit));
+    }
+
+    __attribute__((target("avx2")))
+    static Masks classify_avx2(const char* p, bool whitespace) {
+        const __m256i lo = _mm256_set1_epi8('a' - 1), hi = _mm256_set1_epi8('z' + 1), bit = _mm256_set1_epi8(0x20);
+        const __m256i nl = _mm256_set1_epi8('\n'), sp = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t' - 1), cr = _mm256_set1_epi8('\r' + 1);
+        Masks m{0, 0, 0};
+        for (int k = 0; k < 2; ++k) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * k));
+            __m256i f = _mm256_or_si256(v, bit);
+            __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(f, lo), _mm256_cmpgt_epi8(hi, f));
+            __m256i sep = _mm256_cmpeq_epi8(v, nl);
+            if (whitespace) {
+                sep = _mm256_or_si256(sep, _mm256_cmpeq_epi8(v, sp));
+                sep = _mm256_or_si256(sep, _mm256_and_si256(_mm256_cmpgt_epi8(v, tab), _mm256_cmpgt_epi8(cr, v)));
+            }
+            m.letters |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(letter))) << (32 * k);
+            m.separators |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(sep))) << (32 * k);
+            m.high |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(v))) << (32 * k);
+        }
+        return m;
+    }
+
+    __attribute__((target("avx2")))
+    static void fold_avx2(char* dst, const char* src) {
+        const __m256i bit = _mm256_set1_epi8(0x20);
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_or_si256(a, bit));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_or_si256(b, bit));
+    }
+#endif
+
+    static const Kernel& scalar_kernel() {
+        static const Kernel k{"escalar", classify_scalar, fold_scalar};
+        return k;
+    }
+
+    // Kernels que puede usar esta CPU, del más simple al más ancho
+    static size_t available_kernels(const Kernel** out) {
+        size_t n = 0;
+        out[n++] = &scalar_kernel();
+#ifdef TOKENIZER_X86
+        static const Kernel sse2{"sse2", classify_sse2, fold_sse2};
+        static const Kernel avx2{"avx2", classify_avx2, fold_avx2};
+        out[n++] = &sse2;
+        if (__builtin_cpu_supports("avx2")) out[n++] = &avx2;
+#endif
+        return n;
+    }
+
+    // El más ancho disponible; se elige una sola vez
+    static const Kernel& kernel() {
+        static const Kernel* best = [] {
+            const Kernel* ks[3];
+            return ks[available_kernels(ks) - 1];
+        }();
+        return *best;
+    }
+
+    // --------------------------------------------------------
+    // Recorrido
+    // --------------------------------------------------------
+
+    // Normaliza data[0, n) en el lugar (la escritura nunca pasa a la
+    // lectura) y llama emit(offset, largo) por cada token de al menos
+    // min_length letras. Con `final` el último token termina en n; si no,
+    // queda sin emitir y se retorna su inicio (ya normalizado en
+    // data[inicio, fin), con fin en *out_end) para continuarlo después.
+    // Los primeros `normalized` bytes son el comienzo ya normalizado del
+    // primer token (lo que quedó pendiente de la llamada anterior). Sin
+    // `final`, data no debe terminar a mitad de una secuencia UTF-8.
+    template <class Alphabet = AsciiAlphabet, class Emit>
+    static size_t run(const Kernel& k, char* data, size_t n, bool whitespace, size_t min_length,
+                      bool final, Emit&& emit, size_t* out_end = nullptr, size_t normalized = 0) {
+        size_t out = normalized, start = 0, i = normalized;
+        auto finish = [&](size_t end) {
+            if (end > start && end - start >= min_length) emit(start, end - start);
+        };
+        // Byte no ASCII en data[i]: una letra Latin-1 ocupa dos bytes y
+        // queda en uno; cualquier otro se descarta
+        auto latin1 = [&] {
+            unsigned char c = static_cast<unsigned char>(data[i]);
+            unsigned char next = (i + 1 < n) ? static_cast<unsigned char>(data[i + 1]) : 0;
+            if (c == 0xC3 && (next & 0xC0) == 0x80) {
+                unsigned char f = Alphabet::fold_latin1(next + 0x40);
+                if (f) data[out++] = static_cast<char>(f);
+                i += 2;
+            } else {
+                ++i;
+            }
+        };
+        auto scalar = [&](size_t to) {
+            while (i < to) {
+                unsigned char c = static_cast<unsigned char>(data[i]);
+                if (is_letter(c)) {
+                    data[out++] = fold_letter(c);
+                } else if (Alphabet::UTF8 && c >= 0x80) {
+                    latin1();
+                    continue;
+                } else if (is_separator(c, whitespace)) {
+                    finish(out);
+                    start = out;
+                }
+                ++i;
+            }
+        };
+
+        while (i + BLOCK <= n) {
+            Masks m = k.classify(data + i, whitespace);
+            if ((m.letters | m.separators) != ~0ull) {
+                // Con bytes descartados: se copian solo las letras, saltando
+                // de bit en bit en vez de mirar cada byte. Con UTF-8, solo
+                // hasta el primer byte no ASCII
+                uint64_t keep = m.letters | m.separators;
+                size_t stop = BLOCK;
+                if (Alphabet::UTF8 && m.high) {
+                    stop = __builtin_ctzll(m.high);
+                    keep &= (1ull << stop) - 1;
+                }
+                char folded[BLOCK];
+                k.fold(folded, data + i);
+                for (; keep; keep &= keep - 1) {
+                    unsigned j = __builtin_ctzll(keep);
+                    if ((m.separators >> j) & 1) {
+                        finish(out);
+                        start = out;
+                    } else {
+                        data[out++] = folded[j];
+                    }
+                }
+                if (stop < BLOCK) {
+                    size_t block_end = i + BLOCK;
+                    i += stop;
+                    scalar(block_end);
+                    continue;
+                }
+                i += BLOCK;
+                continue;
+            }
+            // Bloque sin bytes descartados: se copia entero y cada separador
+            // queda como un byte de relleno entre tokens
+            k.fold(data + out, data + i);
+            for (uint64_t s = m.separators; s; s &= s - 1) {
+                size_t at = out + __builtin_ctzll(s);
+                finish(at);
+                start = at + 1;
+            }
+            out += BLOCK;
+            i += BLOCK;
+        }
+        scalar(n);
+
+        if (final) {
+            finish(out);
+            start = out;
+        }
+        if (out_end) *out_end = out;
+        return start;
+    }
+};
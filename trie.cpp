@@ -1,89 +1,315 @@
 #pragma once
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cctype>
+#include <cmath>
 #include <cstdint>
-#include <deque>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <string>
-#include <functional> 
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "alphabet.cpp"
+#include "arena.cpp"
+#include "thread_pool.cpp"
+#include "tokenizer.cpp"
 
 
 // Trie con funcionalidades de autocompletado
-// Variante: modo MÁS RECIENTE o MÁS FRECUENTE
+// Variante: modo MÁS RECIENTE, MÁS FRECUENTE o frecuencia con decaimiento,
+// como política de ranking
+// El alfabeto es un parámetro de plantilla (alphabet.cpp): Trie<R> es el de
+// 26 letras ASCII y SpanishTrie<R> agrega ñ y las vocales con tilde.
 
-struct Trie {
-    // --------------------------------------------------------
-    // Tipos y estructuras
-    // --------------------------------------------------------
-    enum class Variant { MOST_RECENT, MOST_FREQUENT };
+// Tipos que no dependen del alfabeto ni del ranking
+struct TrieTypes {
+    enum class Variant { MOST_RECENT, MOST_FREQUENT, DECAYED };
+
+    // Tipos de nodo adaptativos (ver ChildBlocks en arena.cpp)
+    typedef ChildBlockKinds::Kind NodeKind;
+    static const int NUM_KINDS = ChildBlockKinds::NUM_KINDS;
+
+    // Índice de nodo / slot; NONE hace de nullptr
+    typedef uint32_t Id;
+    static const Id NONE = 0xFFFFFFFFu;
+
+    // Mejor terminal de un subárbol junto con la prioridad que tenía al
+    // propagarse, en una sola palabra para poder cambiar ambos con un CAS:
+    // (prioridad << 32) | terminal. La prioridad guardada cabe en 32 bits:
+    // update_priority() renormaliza todas las prioridades antes de pasar
+    // MAX_PRIORITY y update_priority_shared() se queda en ese tope.
+    static constexpr int64_t MAX_PRIORITY = 0xFFFFFFFFll;
+    static uint64_t make_best(int64_t priority, Id terminal) {
+        assert(priority >= 0 && priority <= MAX_PRIORITY);
+        return (static_cast<uint64_t>(priority) << 32) | terminal;
+    }
+    static const uint64_t NO_BEST = 0xFFFFFFFFull;   // sin terminal
 
+    // Los nodos viven en una arena y se enlazan con índices de 32 bits
     struct Node {
-        Node* parent = nullptr;
-        std::array<Node*, 27> next;  // sigma = 26 letras + '$'
         int64_t priority = 0;          
-        const std::string* str = nullptr; // puntero estable a string (solo terminal)
-        Node* best_terminal = nullptr; // mejor terminal del subárbol
-        int64_t best_priority = std::numeric_limits<int64_t>::min();
+        uint64_t best = NO_BEST;       // mejor terminal del subárbol (make_best)
+        Id id = NONE;                  // posición propia en la arena
+        Id parent = NONE;
+        Id kids = NONE;                // bloque de hijos en blocks_ (NONE si es hoja)
+        Id word = NONE;                // índice de palabra, ver word_at() (solo terminal)
+        uint8_t kind = ChildBlockKinds::N0;
+        uint8_t count = 0;             // hijos usados en el bloque
+        uint8_t topk_count = 0;        // candidatos usados en su lista top-k
 
-        Node() : next() { next.fill(nullptr); }
-        bool is_terminal() const { return str != nullptr; }
+        bool is_terminal() const { return word != NONE; }
+        Id best_terminal() const { return static_cast<Id>(best); }
+        int64_t best_priority() const {
+            return best_terminal() == NONE ? std::numeric_limits<int64_t>::min()
+                                           : static_cast<int64_t>(best >> 32);
+        }
     };
+};
+
+// --------------------------------------------------------
+// Políticas de ranking
+// --------------------------------------------------------
+// Deciden la prioridad nueva de un terminal cada vez que se usa y quién
+// gana un empate. BasicTrie recibe la política como parámetro de plantilla,
+// así update_priority queda especializado y no pregunta el modo en cada
+// ancestro del camino. Una política propia necesita:
+//   VARIANT          el Variant con que se la elige y se anota en el snapshot
+//   NAME             para print_stats
+//   NEWER_WINS_TIES  si en empate el terminal recién usado desplaza al mejor
+//   bump()           prioridad nueva; clock es el contador de accesos del trie
+//   bump_shared()    lo mismo para update_priority_shared (varios hilos);
+//                    solo hace falta si se usa update_priority_shared
+//   rescale()        opcional: corrimiento a la derecha que update_priority
+//                    aplica a todas las prioridades (0 si no toca)
+// La prioridad nueva nunca puede ser menor que la anterior: la propagación
+// corta en el primer ancestro que no mejora. Si bump() pasa MAX_PRIORITY
+// (2^32 - 1, ver make_best) el trie renormaliza: en el modo reciente
+// renumera las prioridades por orden (el reloj vuelve a la cantidad de
+// palabras usadas), en los demás las divide por 2. Es un recorrido de la
+// arena cada ~4 mil millones de usos. Una política con rescale() tiene que
+// quedarse bajo el tope por su cuenta (su reloj define la escala).
+
+// El último uso gana: la prioridad es el valor del reloj de accesos
+struct RecentRanking {
+    static constexpr TrieTypes::Variant VARIANT = TrieTypes::Variant::MOST_RECENT;
+    static constexpr const char* NAME = "MÁS RECIENTE";
+    static constexpr bool NEWER_WINS_TIES = true;
+
+    static int64_t bump(int64_t, int64_t& clock) { return ++clock; }
+
+    static int64_t bump_shared(int64_t& priority, int64_t& clock) {
+        int64_t p = std::atomic_ref<int64_t>(clock).fetch_add(1) + 1;
+        std::atomic_ref<int64_t> current(priority);
+        int64_t seen = current.load();
+        while (seen < p && !current.compare_exchange_weak(seen, p)) {}
+        return p;
+    }
+};
+
+// Cuenta de usos; en empate se queda el que ya estaba
+struct FrequentRanking {
+    static constexpr TrieTypes::Variant VARIANT = TrieTypes::Variant::MOST_FREQUENT;
+    static constexpr const char* NAME = "MÁS FRECUENTE";
+    static constexpr bool NEWER_WINS_TIES = false;
+
+    static int64_t bump(int64_t priority, int64_t&) { return priority + 1; }
+
+    static int64_t bump_shared(int64_t& priority, int64_t&) {
+        return std::atomic_ref<int64_t>(priority).fetch_add(1) + 1;
+    }
+};
+
+// Frecuencia con decaimiento exponencial: un uso de hace HALF_LIFE usos pesa
+// la mitad que uno de ahora. En vez de decaer todas las prioridades en cada
+// uso, el incremento crece: el uso número t suma 2^(BASE_BITS + t/HALF_LIFE)
+// (O(1) por uso) y las prioridades siguen solo subiendo, así que la
+// propagación de update_priority vale tal cual. Antes de que la suma se
+// salga de 32 bits, rescale() pide dividir todo por 2^RESCALE_BITS: un
+// recorrido de la arena cada RESCALE_BITS * HALF_LIFE usos. Dividir no
+// invierte ningún orden (a lo más crea empates por redondeo).
+// Ese update_priority ya no es O(profundidad) sino O(nodos de la arena):
+// con HALF_LIFE = 1024 es una de cada 17408 llamadas y en el trie de
+// wikipedia.txt tarda ~1 ms (trie_bench, escenario reescalado), unos 60 ns
+// por uso repartidos. Quien necesite latencia acotada por llamada no debe
+// usar este modo.
+template <int HALF_LIFE = 1024>
+struct DecayedRanking {
+    static constexpr TrieTypes::Variant VARIANT = TrieTypes::Variant::DECAYED;
+    static constexpr const char* NAME = "FRECUENCIA CON DECAIMIENTO";
+    static constexpr bool NEWER_WINS_TIES = true;
+
+    static constexpr int BASE_BITS = 4;   // incremento inicial: resolución del redondeo
+
+    // Mayor corrimiento con el que la suma de todos los incrementos hasta el
+    // reescalado, < 2^(BASE_BITS + R) * HALF_LIFE / ln 2, cabe en 32 bits
+    static constexpr int rescale_bits() {
+        int r = 1;
+        while ((1ll << (BASE_BITS + r + 1)) * (HALF_LIFE * 3 / 2 + 1) <= 0xFFFFFFFFll) ++r;
+        return r;
+    }
+    static constexpr int RESCALE_BITS = rescale_bits();
+    static_assert(HALF_LIFE > 0 && (1ll << (BASE_BITS + 1)) * (HALF_LIFE * 3 / 2 + 1) <= 0xFFFFFFFFll,
+                  "HALF_LIFE demasiado grande para prioridades de 32 bits");
+
+    // clock: usos desde el último reescalado
+    static int64_t increment(int64_t clock) {
+        return std::llround(std::ldexp(std::exp2(static_cast<double>(clock % HALF_LIFE) / HALF_LIFE),
+                                       static_cast<int>(BASE_BITS + clock / HALF_LIFE)));
+    }
+
+    static int64_t bump(int64_t priority, int64_t& clock) { return priority + increment(clock++); }
+
+    static int rescale(int64_t& clock) {
+        const int64_t period = static_cast<int64_t>(RESCALE_BITS) * HALF_LIFE;
+        if (clock < period) return 0;
+        clock -= period;
+        return RESCALE_BITS;
+    }
+};
+
+// Llama a f con la política que corresponde al modo elegido en la línea de
+// comandos: el switch se paga una vez al arrancar y todo lo que f instancia
+// (trie, simulación) ya queda especializado
+template <class F>
+decltype(auto) with_ranking(TrieTypes::Variant variant, F&& f) {
+    switch (variant) {
+        case TrieTypes::Variant::MOST_RECENT:
+            return f(RecentRanking{});
+        case TrieTypes::Variant::DECAYED:
+            return f(DecayedRanking<>{});
+        case TrieTypes::Variant::MOST_FREQUENT:
+        default:
+            return f(FrequentRanking{});
+    }
+}
+
+template <class Alphabet, class Ranking>
+struct BasicTrie : TrieTypes {
+    // --------------------------------------------------------
+    // Tipos y estructuras
+    // --------------------------------------------------------
+    typedef Alphabet AlphabetType;
+    typedef Ranking RankingType;
+    static constexpr Variant variant = Ranking::VARIANT;
+    // La política se reescala sola (rescale()) y nunca pasa MAX_PRIORITY
+    static constexpr bool RESCALES = requires(int64_t& clock) { Ranking::rescale(clock); };
+    static const int ALPHABET_SIZE = Alphabet::SIZE;   // letras + '$'
+    static const int END = Alphabet::END;              // hijo '$'
 
     // --------------------------------------------------------
     // Atributos del trie
     // --------------------------------------------------------
-    Variant variant;
     Node* root_ = nullptr;
     int64_t access_counter_ = 0;       // para modo reciente
     size_t node_count_ = 0;            // cantidad de nodos
     size_t total_chars_ = 0;           // total de caracteres insertados
-    std::deque<std::string> dict_;    
-    size_t dict_bytes_ = 0;            // bytes de palabras almacenadas
+    WordPool words_;                   // palabras en orden de primera inserción
+
+    ChunkArena<Node> nodes_{MemTag::NODES};
+    BasicChildBlocks<ALPHABET_SIZE> blocks_;   // bloques de hijos
+
+    // Listas de candidatos top-k por nodo, ordenadas de mejor a peor:
+    // topk_[id * topk_cap_ + i]. Con topk_cap_ = 0 no se mantienen.
+    size_t topk_cap_ = 0;
+    std::vector<Id> topk_;
+
+    // Presupuesto de memoria (ver set_budget). Lista LRU doble enlazada
+    // sobre índices de palabra: lru_head_ es la última usada y lru_tail_ la
+    // próxima a desalojar. Los nodos liberados se reusan, así que con
+    // presupuesto un hijo ya no tiene siempre índice mayor que su padre.
+    size_t budget_bytes_ = 0, budget_words_ = 0;   // 0: sin límite
+    std::vector<Id> lru_prev_, lru_next_;
+    std::vector<Id> word_terminal_;                // palabra -> nodo '$'
+    Id lru_head_ = NONE, lru_tail_ = NONE;
+    std::vector<Id> free_nodes_;
+    size_t evictions_ = 0;
+
+    // Ventana deslizante (ver set_window): terminales de los últimos
+    // window_cap_ usos, circular; window_next_ es el más antiguo cuando
+    // la ventana está llena
+    size_t window_cap_ = 0, window_next_ = 0;
+    std::vector<Id> window_;
+
+    // Snapshot abierto con open(): las arenas apuntan dentro de este mapeo
+    struct Unmap {
+        size_t bytes;
+        void operator()(char* p) const { munmap(p, bytes); }
+    };
+    std::unique_ptr<char, Unmap> mapping_{nullptr, Unmap{0}};
 
     // --------------------------------------------------------
     // Constructor
     // --------------------------------------------------------
-    Trie(Variant v) : variant(v) {
-        root_ = new Node();
-        node_count_ = 1;
-        total_chars_ = 0;
-        root_->best_priority = std::numeric_limits<int64_t>::min();
-        root_->best_terminal = nullptr;
+    explicit BasicTrie(size_t topk = 0) : topk_cap_(std::min<size_t>(topk, 255)) {
+        reset();
     }
 
-    ~Trie() {
-        // Función auxiliar para eliminar recursivamente
-        std::function<void(Node*)> delete_node = [&](Node* node) {
-            if (!node) return;
-            for (int i = 0; i < 27; ++i) {
-                if (node->next[i]) {
-                    delete_node(node->next[i]);
-                }
-            }
-            delete node;
-        };
-        delete_node(root_);
+    // Vacía el trie soltando los chunks completos de la arena
+    void reset() {
+        clear_storage();
+        root_ = new_node(NONE);
     }
 
     // --------------------------------------------------------
     // Funciones auxiliares
     // --------------------------------------------------------
-    static int idx_of(char c) {
-        if (c == '$') return 26;
-        if ('a' <= c && c <= 'z') return c - 'a';
-        return -1;
+    // Hijo de la letra c (también en mayúscula) o de '$'; -1 si no es del alfabeto
+    static int idx_of(char c) { return alphabet_index<Alphabet>(c); }
+
+    Node* node(Id i) { return i == NONE ? nullptr : &nodes_[i]; }
+    const Node* node(Id i) const { return i == NONE ? nullptr : &nodes_[i]; }
+
+    // Si el nodo de la arena está en el árbol: los liberados por el
+    // presupuesto quedan sin padre. Los recorridos de toda la arena saltan
+    // los que no
+    bool is_live(const Node& u) const { return u.parent != NONE || &u == root_; }
+
+    std::string_view word(const Node* terminal) const { return word_at(terminal->word); }
+
+    // Palabra w en orden de primera inserción
+    std::string_view word_at(Id w) const { return words_[w]; }
+
+    Id child(const Node* u, int idx) const { return blocks_.child(u, idx); }
+
+    Node* new_node(Id parent) {
+        Id i;
+        if (!free_nodes_.empty()) {
+            i = free_nodes_.back();
+            free_nodes_.pop_back();
+            nodes_[i] = Node();
+        } else {
+            i = nodes_.alloc();
+        }
+        Node* n = &nodes_[i];
+        n->id = i;
+        n->parent = parent;
+        ++node_count_;
+        blocks_.note_new_node();
+        if (topk_cap_ && topk_.size() < nodes_.size() * topk_cap_) {
+            MemTagScope scope(MemTag::TOPK);
+            topk_.resize(topk_.size() + topk_cap_, static_cast<Id>(NONE));
+        }
+        return n;
     }
 
     Node* ensure_child(Node* u, int idx) {
-        if (!u->next[idx]) {
-            u->next[idx] = new Node();
-            u->next[idx]->parent = u;
-            ++node_count_;
-        }
-        return u->next[idx];
+        Id c = child(u, idx);
+        if (c != NONE) return &nodes_[c];
+
+        Node* n = new_node(u->id);
+        blocks_.add_child(u, idx, n->id);
+        return n;
     }
 
     // --------------------------------------------------------
@@ -91,109 +317,932 @@ struct Trie {
     // --------------------------------------------------------
 
     // Inserta una palabra y retorna su nodo terminal
-    Node* insert(const std::string& w_raw) {
-        std::string w;
-        w.reserve(w_raw.size());
-        for (char c : w_raw)
-            if (std::isalpha((unsigned char)c))
-                w.push_back((char)std::tolower((unsigned char)c));
+    // Las palabras que vienen de Corpus/TokenStream ya están normalizadas y
+    // se bajan directo; cualquier otra pasa antes por
+    // Tokenizer::normalize_word (solo letras, en minúscula, UTF-8 decodificado)
+    Node* insert(std::string_view w_raw) {
+        if (!Tokenizer::is_normalized<Alphabet>(w_raw)) return insert(Tokenizer::normalize_word<Alphabet>(w_raw));
+        // El largo se mide ya normalizado, como en RadixTrie
+        if (w_raw.size() > WordPool::MAX_LENGTH) {
+            std::cerr << "Error: palabra de más de " << WordPool::MAX_LENGTH << " letras, no se inserta" << std::endl;
+            return nullptr;
+        }
+        Node* u = root_;
+        for (char c : w_raw) u = ensure_child(u, idx_of(c));
+        size_t letters = w_raw.size();
 
         // Si la palabra está vacía después de filtrar, no insertar
-        if (w.empty()) return nullptr;
-
-        Node* u = root_;
-        for (char c : w) {
-            int k = idx_of(c);
-            if (k < 0) continue;
-            u = ensure_child(u, k);
-            total_chars_++; // Contar cada carácter insertado
-        }
+        if (letters == 0) return nullptr;
+        total_chars_ += letters; // Contar cada carácter insertado
 
         // Crear o bajar al nodo '$'
-        u = ensure_child(u, 26);
         total_chars_++; // Contar el carácter '$'
+        Node* t = node(child(u, END));
 
-        // Si no era terminal, asociar string
-        if (!u->is_terminal()) {
-            dict_.push_back(w);            
-            dict_bytes_ += w.size();
-            u->str = &dict_.back();
-            
-            // Inicializar prioridad según variante
-            switch (variant) {
-                case Variant::MOST_RECENT:
-                    u->priority = 0; // Se actualizará cuando se acceda
-                    break;
-                case Variant::MOST_FREQUENT:
-                    u->priority = 0; // Empieza con frecuencia 0
-                    break;
+        // Si no existía, asociar string antes de colgarlo del árbol, para que
+        // un lector concurrente nunca vea un '$' sin palabra
+        if (!t) {
+            t = new_node(u->id);
+            t->word = words_.append(w_raw);
+            t->priority = 0; // Sin usos todavía, en cualquier ranking
+
+            blocks_.add_child(u, END, t->id);
+            propagate_if_better(t);
+            update_topk(t);
+            if (budgeted()) {
+                lru_add(t);
+                enforce_budget();
             }
-            
-            propagate_if_better(u);
+        } else if (budgeted()) {
+            lru_touch(t->word);
         }
+        u = t;
         return u;
     }
 
+    // --------------------------------------------------------
+    // Construcción en paralelo
+    // --------------------------------------------------------
+
+    // Índice de la primera letra que insert() usaría (-1 si no hay ninguna)
+    static int first_letter(std::string_view w) {
+        if (Tokenizer::is_normalized<Alphabet>(w)) return w.empty() ? -1 : idx_of(w[0]);
+        std::string n = Tokenizer::normalize_word<Alphabet>(w);
+        return n.empty() ? -1 : idx_of(n[0]);
+    }
+
+    // Reemplaza el contenido por las palabras de `words` (cualquier cosa con
+    // size() y operator[] a string_view, p.ej. Corpus) y deja lo mismo que
+    // insertarlas en orden con insert(): mismos nodos, caracteres, diccionario
+    // en el mismo orden, mejores terminales y listas top-k.
+    // Los hijos de la raíz parten las palabras por primera letra en subárboles
+    // independientes: cada uno se arma en un Trie propio (con sus arenas) en
+    // algún hilo, y después se cuelga de la raíz copiando sus nodos seguidos
+    // en la arena, adoptando sus bloques y sumando una base a los índices.
+    template <class Words>
+    void build_parallel(const Words& words, size_t threads) {
+        assert(!budgeted() && !window_cap_);
+        reset();
+
+        struct Shard {
+            std::unique_ptr<BasicTrie> trie;
+            std::vector<uint32_t> input;       // posiciones en words, en orden
+            std::vector<uint32_t> first_seen;  // primera aparición de cada palabra nueva
+            std::vector<Id> word_ids;          // palabra local -> índice en words_
+            Id size = 0, node_base = 0, block_base = 0;
+            Id top = NONE;                     // hijo de la raíz, ya con la base
+        };
+        std::vector<Shard> shards(Alphabet::LETTERS);
+        for (size_t i = 0; i < words.size(); ++i) {
+            int k = first_letter(words[i]);
+            if (k >= 0) shards[k].input.push_back(static_cast<uint32_t>(i));
+        }
+
+        parallel_for(shards.size(), threads, [&](size_t k) {
+            Shard& s = shards[k];
+            if (s.input.empty()) return;
+            s.trie.reset(new BasicTrie(topk_cap_));
+            for (uint32_t i : s.input) {
+                size_t before = s.trie->word_count();
+                s.trie->insert(words[i]);
+                if (s.trie->word_count() != before) s.first_seen.push_back(i);
+            }
+            std::vector<uint32_t>().swap(s.input);
+        });
+
+        // Diccionario en orden de primera aparición; dentro de cada shard las
+        // palabras ya están en ese orden, así que el índice local es correlativo
+        std::vector<std::pair<uint32_t, uint32_t>> order;
+        for (uint32_t k = 0; k < shards.size(); ++k) {
+            for (uint32_t i : shards[k].first_seen) order.emplace_back(i, k);
+            shards[k].word_ids.resize(shards[k].first_seen.size());
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<Id> next_local(shards.size(), 0);
+        for (const auto& p : order) {
+            Shard& s = shards[p.second];
+            Id local = next_local[p.second]++;
+            s.word_ids[local] = words_.append(s.trie->words_[local]);
+        }
+
+        // Reservar los nodos de cada shard seguidos en la arena, sin su raíz:
+        // el nodo local i (i >= 1) va a node_base + i, así que la arena y
+        // topk_ quedan sin huecos, del mismo tamaño que insertando en orden.
+        // Los bloques de hijos sí se adoptan por chunks
+        std::vector<int> letters;
+        for (int k = 0; k < static_cast<int>(shards.size()); ++k) {
+            Shard& s = shards[k];
+            if (!s.trie) continue;
+            s.size = static_cast<Id>(s.trie->nodes_.size());
+            s.node_base = nodes_.extend(s.size - 1) - 1;
+            s.block_base = blocks_.adopt(s.trie->blocks_);
+            node_count_ += s.trie->node_count_ - 1;
+            total_chars_ += s.trie->total_chars_;
+
+            Node r = s.trie->nodes_[0];
+            r.kids += s.block_base;
+            s.top = blocks_.child(&r, k) + s.node_base;
+            blocks_.discard(&r);
+            --blocks_.kind_count_[ChildBlockKinds::N0];
+            letters.push_back(k);
+        }
+        if (topk_cap_) {
+            MemTagScope scope(MemTag::TOPK);
+            topk_.resize(nodes_.size() * topk_cap_, static_cast<Id>(NONE));
+        }
+
+        parallel_for(shards.size(), threads, [&](size_t k) {
+            Shard& s = shards[k];
+            if (!s.trie) return;
+            for (Id local = 1; local < s.size; ++local) {
+                Node* u = &nodes_[s.node_base + local];
+                *u = s.trie->nodes_[local];
+                u->id += s.node_base;
+                u->parent = (u->parent == 0) ? root_->id : u->parent + s.node_base;
+                if (u->kids != NONE) {
+                    u->kids += s.block_base;
+                    blocks_.rebase_children(u, s.node_base);
+                }
+                if (u->best_terminal() != NONE)
+                    u->best = make_best(u->best_priority(), u->best_terminal() + s.node_base);
+                if (u->is_terminal()) u->word = s.word_ids[u->word];
+                if (topk_cap_) {
+                    const Id* src = &s.trie->topk_[local * topk_cap_];
+                    Id* dst = &topk_[u->id * topk_cap_];
+                    for (int i = 0; i < u->topk_count; ++i) dst[i] = src[i] + s.node_base;
+                }
+            }
+            s.trie.reset();
+        });
+
+        // Colgar los subárboles en el orden en que aparecieron sus letras.
+        // Todas las prioridades son 0, así que el mejor de la raíz es la
+        // primera palabra insertada y su lista top-k son las primeras k.
+        std::sort(letters.begin(), letters.end(), [&](int a, int b) {
+            return shards[a].first_seen[0] < shards[b].first_seen[0];
+        });
+        std::vector<Id> candidates;
+        for (int k : letters) {
+            Node* c = &nodes_[shards[k].top];
+            blocks_.add_child(root_, k, c->id);
+            const Id* list = topk_cap_ ? &topk_[c->id * topk_cap_] : nullptr;
+            candidates.insert(candidates.end(), list, list + c->topk_count);
+        }
+        if (!letters.empty()) {
+            const Node* first = &nodes_[shards[letters[0]].top];
+            root_->best = first->best;
+        }
+        if (topk_cap_) {
+            std::sort(candidates.begin(), candidates.end(), [&](Id a, Id b) {
+                return nodes_[a].word < nodes_[b].word;
+            });
+            size_t n = std::min(candidates.size(), topk_cap_);
+            std::copy(candidates.begin(), candidates.begin() + n, &topk_[root_->id * topk_cap_]);
+            root_->topk_count = static_cast<uint8_t>(n);
+        }
+    }
+
+    Node* root() const { return root_; }
+
     // Descender un carácter desde nodo v
     Node* descend(Node* v, char c) const {
         if (!v) return nullptr;
-        char cc = (c == '$') ? '$' : (char)std::tolower((unsigned char)c);
-        int k = idx_of(cc);
+        int k = idx_of(c);
         if (k < 0) return nullptr;
-        return v->next[k];
+        return const_cast<Node*>(node(child(v, k)));
     }
 
     // Retorna el mejor terminal en el subárbol
     Node* autocomplete(Node* v) const {
         if (!v) return nullptr;
-        return v->best_terminal;
+        return const_cast<Node*>(node(v->best_terminal()));
+    }
+
+    // Sesión de tecleo: avanza una tecla a la vez desde la raíz, guarda el
+    // nodo actual y cachea el terminal '$' la primera vez que se pide.
+    // Las sugerencias se comparan por identidad de nodo, sin copiar strings.
+    struct Cursor {
+        const BasicTrie* trie;
+        Node* cur;
+        Node* term = nullptr;          // terminal cacheado del nodo actual
+        size_t depth = 0;              // teclas aceptadas
+
+        explicit Cursor(const BasicTrie& t) : trie(&t), cur(t.root_) {}
+
+        // Avanza con la tecla c; retorna false si no hay palabras con ese prefijo
+        bool advance(char c) {
+            cur = trie->descend(cur, c);
+            term = nullptr;
+            if (!cur) return false;
+            ++depth;
+            return true;
+        }
+
+        bool valid() const { return cur != nullptr; }
+        Node* node() const { return cur; }
+        Node* suggestion() const { return trie->autocomplete(cur); }
+
+        // Terminal de la palabra escrita hasta ahora (nullptr si no existe)
+        Node* terminal() {
+            if (!term && cur) term = trie->descend(cur, '$');
+            return term;
+        }
+    };
+
+    // --------------------------------------------------------
+    // Búsqueda por lotes
+    // --------------------------------------------------------
+    // Bajar un prefijo es una cadena de fallos de caché que dependen uno del
+    // otro (nodo -> bloque de hijos -> hijo). descend_batch intercala hasta
+    // MAX_BATCH prefijos (AMAC): cada visita a una consulta da un solo paso,
+    // deja pedido con prefetch lo que el paso siguiente va a leer y pasa a
+    // la próxima consulta, así los fallos de consultas distintas se solapan.
+    // Cuando una consulta termina, su lugar lo toma la siguiente pendiente.
+    static const size_t MAX_BATCH = 64;
+
+    // out[i] = nodo del prefijo prefixes[i] (lo mismo que encadenar
+    // descend), o nullptr si no hay palabras con ese prefijo
+    void descend_batch(const std::string_view* prefixes, size_t n, Node** out) const {
+        struct Lane {
+            const Node* u;
+            const char* next;          // siguiente carácter del prefijo
+            const char* end;
+            uint32_t query;
+            int8_t key;                // idx_of del carácter en curso
+            bool block_ready;          // ya se pidió el bloque de hijos de u
+        };
+
+        // Con un solo prefijo no hay fallos que solapar
+        if (n == 1) {
+            Node* u = root_;
+            for (char c : prefixes[0])
+                if (!(u = descend(u, c))) break;
+            out[0] = u;
+            return;
+        }
+
+        Lane lanes[MAX_BATCH];
+        size_t pending = 0, active = 0;
+        // Carga en l la siguiente consulta pendiente que no sea trivial y
+        // pide el bloque de hijos de la raíz
+        auto load = [&](Lane& l) {
+            while (pending < n) {
+                uint32_t q = static_cast<uint32_t>(pending++);
+                std::string_view p = prefixes[q];
+                int k = p.empty() ? -1 : idx_of(p[0]);
+                if (k < 0) {
+                    out[q] = p.empty() ? root_ : nullptr;
+                    continue;
+                }
+                l = Lane{root_, p.data() + 1, p.data() + p.size(), q, static_cast<int8_t>(k), true};
+                blocks_.prefetch(root_, k);
+                return true;
+            }
+            return false;
+        };
+
+        while (active < MAX_BATCH && load(lanes[active])) ++active;
+        size_t j = 0;
+        while (active > 0) {
+            Lane& l = lanes[j];
+            bool done = false;
+            if (!l.block_ready) {
+                // El nodo ya está en caché: pedir su bloque de hijos
+                blocks_.prefetch(l.u, l.key);
+                l.block_ready = true;
+            } else {
+                // El bloque ya está en caché: buscar el hijo y pedirlo
+                Id c = child(l.u, l.key);
+                if (c == NONE) {
+                    out[l.query] = nullptr;
+                    done = true;
+                } else if (l.next == l.end) {
+                    out[l.query] = const_cast<Node*>(&nodes_[c]);
+                    done = true;
+                } else {
+                    int k = idx_of(*l.next++);
+                    if (k < 0) {
+                        out[l.query] = nullptr;
+                        done = true;
+                    } else {
+                        l.u = &nodes_[c];
+                        l.key = static_cast<int8_t>(k);
+                        l.block_ready = false;
+                        __builtin_prefetch(l.u);
+                    }
+                }
+            }
+            if (done && !load(l)) {
+                // Sin consultas pendientes: el último carril ocupa este
+                // lugar y se atiende en la próxima vuelta
+                l = lanes[--active];
+                if (j >= active) j = 0;
+                continue;
+            }
+            j = (j + 1 < active) ? j + 1 : 0;
+        }
+    }
+
+    // out[i] = mejor terminal con el prefijo prefixes[i] (autocomplete sobre
+    // descend_batch), o nullptr. No toca prioridades.
+    void autocomplete_batch(const std::string_view* prefixes, size_t n, Node** out) const {
+        descend_batch(prefixes, n, out);
+        for (size_t i = 0; i < n; ++i) out[i] = autocomplete(out[i]);
+    }
+
+    // --------------------------------------------------------
+    // Lectura concurrente
+    // --------------------------------------------------------
+    // Varios hilos pueden llamar descend_shared/autocomplete_shared/
+    // terminal_shared sin locks mientras un único escritor llama insert() y
+    // update_priority(), siempre dentro de un EpochManager::Guard. Los nodos
+    // nunca se mueven, así que un Node* obtenido sigue valiendo; word(),
+    // top_k() y reset() quedan solo para el escritor.
+    void enable_concurrent_reads(EpochManager* epoch) { blocks_.epoch_ = epoch; }
+
+    Node* node_shared(Id i) const { return i == NONE ? nullptr : const_cast<Node*>(&nodes_.shared(i)); }
+
+    Node* descend_shared(Node* v, char c) const {
+        if (!v) return nullptr;
+        int k = idx_of(c);
+        if (k < 0) return nullptr;
+        return node_shared(blocks_.child_shared(v, k));
+    }
+
+    Node* autocomplete_shared(Node* v) const {
+        if (!v) return nullptr;
+        return node_shared(static_cast<Id>(load_shared(v->best, std::memory_order_acquire)));
+    }
+
+    Node* terminal_shared(Node* v) const { return descend_shared(v, '$'); }
+
+    // Copia en out los hasta k mejores terminales del subárbol de v, en O(k)
+    size_t top_k(const Node* v, size_t k, Node** out) const {
+        if (!v || !topk_cap_) return 0;
+        size_t n = std::min<size_t>(k, v->topk_count);
+        const Id* list = &topk_[v->id * topk_cap_];
+        for (size_t i = 0; i < n; ++i) out[i] = const_cast<Node*>(&nodes_[list[i]]);
+        return n;
     }
 
     // Actualiza prioridad de un nodo terminal y propaga hacia la raíz
     void update_priority(Node* terminal) {
         assert(terminal && terminal->is_terminal());
         
-        switch (variant) {
-            case Variant::MOST_RECENT:
-                terminal->priority = ++access_counter_;
-                break;
-            case Variant::MOST_FREQUENT:
-                terminal->priority += 1;
-                break;
+        int64_t p = Ranking::bump(terminal->priority, access_counter_);
+        if constexpr (!RESCALES) {
+            // bump() ya corrió (y movió el reloj): después de renormalizar
+            // solo se recalcula el valor, en la escala nueva
+            if (p > MAX_PRIORITY) {
+                int64_t delta = p - terminal->priority;
+                renormalize_priorities();
+                p = (variant == Variant::MOST_RECENT) ? ++access_counter_ : terminal->priority + delta;
+            }
         }
+        store_shared(terminal->priority, p);
+        update_topk(terminal);
+        if (budgeted()) lru_touch(terminal->word);
 
         // Actualizar el propio nodo terminal
-        terminal->best_priority = terminal->priority;
-        terminal->best_terminal = terminal;
+        set_best(terminal, terminal);
 
         // Propagar hacia la raíz
-        Node* cur = terminal->parent;
+        Node* cur = node(terminal->parent);
         while (cur) {
             bool needs_update = false;
             
             // Si el nodo actual no tiene best_terminal, asignar este
-            if (cur->best_terminal == nullptr) {
+            if (cur->best_terminal() == NONE) {
                 needs_update = true;
             }
             // Si la prioridad del terminal es mayor que la best_priority actual
-            else if (terminal->priority > cur->best_priority) {
+            else if (terminal->priority > cur->best_priority()) {
                 needs_update = true;
             }
-            // Si tienen la misma prioridad, en modo RECIENTE preferir el más reciente
-            else if (terminal->priority == cur->best_priority && 
-                     cur->best_terminal != terminal &&
-                     variant == Variant::MOST_RECENT) {
+            // Si tienen la misma prioridad, según el ranking preferir el más reciente
+            else if (Ranking::NEWER_WINS_TIES &&
+                     terminal->priority == cur->best_priority() &&
+                     cur->best_terminal() != terminal->id) {
                 needs_update = true;
             }
             
             if (needs_update) {
-                cur->best_priority = terminal->priority;
-                cur->best_terminal = terminal;
-                cur = cur->parent;
+                set_best(cur, terminal);
+                cur = node(cur->parent);
             } else {
                 break;
             }
         }
+
+        // La palabra que sale de la ventana baja después de que la que
+        // entra ya quedó propagada
+        if (window_cap_) slide_window(terminal);
+
+        if constexpr (RESCALES) {
+            if (int bits = Ranking::rescale(access_counter_)) rescale_priorities(bits);
+        }
+    }
+
+    // Divide todas las prioridades por 2^bits. Redondear hacia abajo no
+    // invierte ningún par, así que el mejor de cada nodo sigue siendo un
+    // máximo de su subárbol y las listas top-k siguen ordenadas; solo hay
+    // que rehacer la prioridad guardada en cada `best`. Recorre toda la
+    // arena (salta los nodos que no están en el árbol), O(nodos)
+    void rescale_priorities(int bits) {
+        for (Id i = 0; i < nodes_.size(); ++i) {
+            Node& u = nodes_[i];
+            if (is_live(u) && u.is_terminal()) u.priority >>= bits;
+        }
+        refresh_best_priorities();
+    }
+
+    // Hace lugar bajo MAX_PRIORITY sin cambiar el orden de los terminales.
+    // En el modo reciente la prioridad es el reloj: se reemplaza por su
+    // posición entre las distintas (0 sigue siendo nunca usada) y el reloj
+    // sigue desde la última. En los demás se divide por 2. Las políticas con
+    // rescale() no llegan acá: reescalan antes de pasar el tope
+    void renormalize_priorities() {
+        static_assert(!RESCALES, "la política se reescala con rescale()");
+        if constexpr (Ranking::VARIANT != Variant::MOST_RECENT) {
+            rescale_priorities(1);
+        } else {
+            std::vector<int64_t> used;
+            for (Id i = 0; i < nodes_.size(); ++i) {
+                const Node& u = nodes_[i];
+                if (is_live(u) && u.is_terminal() && u.priority > 0) used.push_back(u.priority);
+            }
+            std::sort(used.begin(), used.end());
+            used.erase(std::unique(used.begin(), used.end()), used.end());
+            for (Id i = 0; i < nodes_.size(); ++i) {
+                Node& u = nodes_[i];
+                if (is_live(u) && u.is_terminal() && u.priority > 0)
+                    u.priority = std::lower_bound(used.begin(), used.end(), u.priority) - used.begin() + 1;
+            }
+            access_counter_ = static_cast<int64_t>(used.size());
+            refresh_best_priorities();
+        }
+    }
+
+    // Rehace la prioridad guardada en cada `best` con la actual de su
+    // terminal, tras cambiar prioridades sin cambiar su orden
+    void refresh_best_priorities() {
+        for (Id i = 0; i < nodes_.size(); ++i) {
+            Node& u = nodes_[i];
+            if (!is_live(u)) continue;
+            Id t = u.best_terminal();
+            if (t != NONE) u.best = make_best(nodes_[t].priority, t);
+        }
+    }
+
+    // update_priority() para varios hilos a la vez (sin insert() ni top-k
+    // concurrentes). La prioridad sube con un contador atómico y cada nodo
+    // del camino trata su `best` como un registro de máximo: el CAS solo lo
+    // reemplaza cuando update_priority() lo haría (needs_update) y la
+    // propagación corta en el primer ancestro que no cambia. Otro hilo que
+    // ganó ese CAS con una prioridad mayor o igual sigue propagando la suya.
+    // Sin renormalizar (los demás hilos leen las prioridades): la que se
+    // propaga se queda en MAX_PRIORITY, y pasado ese punto todos empatan.
+    void update_priority_shared(Node* terminal) {
+        assert(terminal && terminal->is_terminal() && !topk_cap_ && !budgeted());
+        int64_t p = std::min(Ranking::bump_shared(terminal->priority, access_counter_), MAX_PRIORITY);
+
+        for (Node* cur = terminal; cur; cur = node(cur->parent)) {
+            if (!offer_best(cur, p, terminal->id)) break;
+        }
+    }
+
+    // --------------------------------------------------------
+    // Presupuesto de memoria
+    // --------------------------------------------------------
+    // Con un presupuesto el trie deja de solo crecer: cuando insert() lo
+    // pasa, desaloja las palabras usadas hace más tiempo (insert y
+    // update_priority cuentan como uso, en cualquier ranking) hasta volver a
+    // entrar. Desalojar suelta el '$' y los nodos que quedan sin hijos, y
+    // rehace el mejor terminal de los ancestros mirando solo la `best` de
+    // sus hijos, que ya resume cada subárbol; sube hasta el primero que no
+    // cambia. max_bytes se compara con approx_memory_bytes() y max_words con
+    // las palabras vivas; 0 es sin límite. Sin top-k ni lectores
+    // concurrentes. Un Node* o string_view obtenido antes de un insert()
+    // puede quedar apuntando a una palabra desalojada. reset() y open()
+    // quitan el presupuesto: la lista LRU no sobrevive al contenido, así que
+    // hay que volver a fijarlo.
+    bool set_budget(size_t max_bytes, size_t max_words) {
+        if (topk_cap_ || blocks_.epoch_ || window_cap_) {
+            std::cerr << "Error: el presupuesto de memoria no admite top-k, lectores concurrentes ni ventana" << std::endl;
+            return false;
+        }
+        bool was_budgeted = budgeted();
+        budget_bytes_ = max_bytes;
+        budget_words_ = max_words;
+        if (!budgeted()) {
+            lru_clear();
+            return true;
+        }
+        // Las palabras que ya estaban entran a la lista en orden de índice
+        if (!was_budgeted) {
+            for (Id w = 0; w < words_.size(); ++w) {
+                Node* u = root_;
+                for (char c : word_at(w)) u = node(child(u, idx_of(c)));
+                Node* t = node(child(u, END));
+                if (t && t->word == w) lru_add(t);
+            }
+        }
+        enforce_budget();
+        return true;
+    }
+
+    bool budgeted() const { return budget_bytes_ || budget_words_; }
+    size_t live_words() const { return words_.live(); }
+    size_t evictions() const { return evictions_; }
+
+    // Saca la palabra del terminal t
+    void evict(Node* t) {
+        assert(t && t->is_terminal() && budgeted());
+        Id w = t->word;
+        lru_unlink(w);
+        words_.release(w);
+        word_terminal_[w] = NONE;
+        ++evictions_;
+
+        // Soltar t y los ancestros que quedan sin hijos (nunca la raíz)
+        Node* u = node(t->parent);
+        Node* gone = t;
+        while (true) {
+            blocks_.remove_child(u, gone->id);
+            free_node(gone);
+            if (u == root_ || u->count > 0) break;
+            gone = u;
+            u = node(u->parent);
+        }
+        repair_best(u);
+    }
+
+private:
+    void free_node(Node* u) {
+        assert(u->kind == ChildBlockKinds::N0);
+        blocks_.note_free_node();
+        --node_count_;
+        u->word = NONE;
+        u->best = NO_BEST;
+        u->parent = NONE;
+        MemTagScope scope(MemTag::NODES);
+        free_nodes_.push_back(u->id);
+    }
+
+    // Mejor terminal de u a partir de la `best` de cada hijo, que ya resume
+    // su subárbol. En empate se queda el que u ya tenía, si sigue ahí, como
+    // al propagar
+    uint64_t best_from_children(const Node* u) const {
+        uint64_t old = u->best;
+        uint64_t best = NO_BEST;
+        blocks_.for_each_child(u, [&](int, Id c) {
+            uint64_t b = nodes_[c].best;
+            if (static_cast<Id>(b) == NONE) return;
+            if (static_cast<Id>(best) == NONE || (b >> 32) > (best >> 32) ||
+                ((b >> 32) == (best >> 32) && b == old)) {
+                best = b;
+            }
+        });
+        return best;
+    }
+
+    // Rehace el mejor de u y sus ancestros hasta el primero que no cambia
+    void repair_best(Node* u) {
+        for (; u; u = node(u->parent)) {
+            uint64_t best = best_from_children(u);
+            if (best == u->best) break;
+            store_shared(u->best, best, std::memory_order_release);
+        }
+    }
+
+    bool over_budget() const {
+        return (budget_words_ && live_words() > budget_words_) ||
+               (budget_bytes_ && approx_memory_bytes() > budget_bytes_);
+    }
+
+    // Desaloja desde la cola mientras haga falta; la última palabra usada
+    // se queda aunque sola ya pase el presupuesto
+    void enforce_budget() {
+        while (over_budget() && lru_tail_ != lru_head_) evict(node(word_terminal_[lru_tail_]));
+        words_.compact_if_sparse();
+    }
+
+    void lru_add(Node* t) {
+        Id w = t->word;
+        if (w >= word_terminal_.size()) {
+            MemTagScope scope(MemTag::OTHER);
+            word_terminal_.resize(w + 1, static_cast<Id>(NONE));
+            lru_prev_.resize(w + 1, static_cast<Id>(NONE));
+            lru_next_.resize(w + 1, static_cast<Id>(NONE));
+        }
+        word_terminal_[w] = t->id;
+        lru_push_front(w);
+    }
+
+    void lru_push_front(Id w) {
+        lru_prev_[w] = NONE;
+        lru_next_[w] = lru_head_;
+        if (lru_head_ != NONE) lru_prev_[lru_head_] = w;
+        lru_head_ = w;
+        if (lru_tail_ == NONE) lru_tail_ = w;
+    }
+
+    void lru_unlink(Id w) {
+        Id p = lru_prev_[w], n = lru_next_[w];
+        (p != NONE ? lru_next_[p] : lru_head_) = n;
+        (n != NONE ? lru_prev_[n] : lru_tail_) = p;
+    }
+
+    void lru_touch(Id w) {
+        if (w == lru_head_) return;
+        lru_unlink(w);
+        lru_push_front(w);
+    }
+
+    void lru_clear() {
+        lru_prev_.clear();
+        lru_next_.clear();
+        word_terminal_.clear();
+        lru_head_ = lru_tail_ = NONE;
+    }
+
+public:
+    size_t lru_bytes() const {
+        return (lru_prev_.capacity() + lru_next_.capacity() + word_terminal_.capacity()) * sizeof(Id);
+    }
+
+    // --------------------------------------------------------
+    // Ventana deslizante
+    // --------------------------------------------------------
+    // Con una ventana de n palabras el modo frecuente cuenta solo los
+    // últimos n usos: update_priority() suma 1 a la palabra que entra y
+    // resta 1 a la que sale. Bajar una prioridad rompe el supuesto de la
+    // propagación normal (cortar en el primer ancestro que ya gana), así
+    // que decrease_priority() sube mientras el ancestro tenga como mejor a
+    // esa palabra y rehace cada uno con la `best` de sus hijos: O(hijos)
+    // por nivel, sin recorrer subárboles. Las prioridades vuelven a 0 al
+    // fijar la ventana; n = 0 la quita, y también reset() y open() (las
+    // prioridades cargadas no salen de ninguna ventana). Sin top-k (las listas no se pueden
+    // rehacer al bajar) ni presupuesto (un desalojo dejaría la ventana
+    // apuntando a un nodo libre).
+    bool set_window(size_t n) {
+        if (Ranking::VARIANT != Variant::MOST_FREQUENT) {
+            std::cerr << "Error: la ventana deslizante solo se aplica al modo frecuente" << std::endl;
+            return false;
+        }
+        if (topk_cap_ || budgeted()) {
+            std::cerr << "Error: la ventana deslizante no admite top-k ni presupuesto de memoria" << std::endl;
+            return false;
+        }
+        window_cap_ = n;
+        window_next_ = 0;
+        window_.clear();
+        window_.shrink_to_fit();
+        for (Id i = 0; i < nodes_.size(); ++i) {
+            Node& u = nodes_[i];
+            if (is_live(u) && u.is_terminal()) u.priority = 0;
+        }
+        refresh_best_priorities();
+        return true;
+    }
+
+    size_t window() const { return window_cap_; }
+    size_t window_bytes() const { return window_.capacity() * sizeof(Id); }
+
+    // Resta 1 a la prioridad del terminal y rehace el mejor de los
+    // ancestros que lo tenían como mejor; el primero que tiene otro no
+    // cambia, porque ese otro ya le ganaba antes de bajar
+    void decrease_priority(Node* terminal) {
+        assert(terminal && terminal->is_terminal() && terminal->priority > 0 && !topk_cap_);
+        store_shared(terminal->priority, terminal->priority - 1);
+        set_best(terminal, terminal);
+
+        for (Node* u = node(terminal->parent); u && u->best_terminal() == terminal->id; u = node(u->parent)) {
+            store_shared(u->best, best_from_children(u), std::memory_order_release);
+        }
+    }
+
+private:
+    // Anota el uso de t; con la ventana llena saca el más antiguo
+    void slide_window(Node* t) {
+        if (window_.size() < window_cap_) {
+            MemTagScope scope(MemTag::OTHER);
+            window_.push_back(t->id);
+            return;
+        }
+        Node* out = &nodes_[window_[window_next_]];
+        window_[window_next_] = t->id;
+        window_next_ = window_next_ + 1 == window_cap_ ? 0 : window_next_ + 1;
+        decrease_priority(out);
+    }
+
+public:
+
+    // --------------------------------------------------------
+    // Snapshot binario
+    // --------------------------------------------------------
+    // Todo se enlaza con índices de 32 bits, así que el archivo no depende
+    // de dónde quede mapeado: cabecera | chunks de nodos | chunks de slots |
+    // listas libres | top-k | chunks de palabras {offset, largo} | chunks
+    // de letras, cada sección alineada a 64 bytes. open() no recorre los
+    // nodos: apunta los directorios de las arenas (también las de words_) a
+    // las secciones del mapeo y solo copia las listas libres y el top-k. El mapeo es privado, así que
+    // update_priority() e insert() siguen funcionando (copy-on-write por
+    // página) sin tocar el archivo.
+    static constexpr char SNAPSHOT_MAGIC[8] = {'T', 'R', 'I', 'E', 'S', 'N', 'P', '1'};
+    static const uint32_t SNAPSHOT_VERSION = 3;
+    static const size_t SNAPSHOT_ALIGN = 64;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t node_bytes;               // sizeof(Node) al guardar
+        uint32_t variant;                  // Ranking::VARIANT al guardar (informativo)
+        uint32_t root;
+        uint32_t alphabet_size;            // Alphabet::SIZE: hijos de un bloque lleno
+        uint32_t reserved;
+        uint64_t topk_cap;
+        int64_t access_counter;
+        uint64_t node_count, total_chars, word_bytes, block_bytes;
+        uint64_t nodes_size, node_chunks, slots_size, slot_chunks;
+        uint64_t kind_count[NUM_KINDS];
+        uint64_t free_count[NUM_KINDS];
+        uint64_t topk_size, refs_size, ref_chunks, chars_size, char_chunks;
+        uint64_t nodes_at, slots_at, free_at, topk_at, refs_at, chars_at, file_bytes;
+    };
+
+    bool save(const std::string& path) const {
+        if (budgeted() || window_cap_) {
+            std::cerr << "Error: un trie con presupuesto de memoria o ventana no se guarda como snapshot" << std::endl;
+            return false;
+        }
+        typedef decltype(blocks_.slots_) Slots;
+        typedef decltype(words_.refs_) Refs;
+        typedef decltype(words_.chars_) Chars;
+        SnapshotHeader h{};
+        std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+        h.version = SNAPSHOT_VERSION;
+        h.node_bytes = sizeof(Node);
+        h.variant = static_cast<uint32_t>(variant);
+        h.root = root_->id;
+        h.alphabet_size = ALPHABET_SIZE;
+        h.topk_cap = topk_cap_;
+        h.access_counter = access_counter_;
+        h.node_count = node_count_;
+        h.total_chars = total_chars_;
+        h.word_bytes = words_.bytes_;
+        h.block_bytes = blocks_.bytes_;
+        h.nodes_size = nodes_.size();
+        h.node_chunks = nodes_.chunk_count();
+        h.slots_size = blocks_.slots_.size();
+        h.slot_chunks = blocks_.slots_.chunk_count();
+        size_t free_total = 0;
+        for (int k = 0; k < NUM_KINDS; ++k) {
+            h.kind_count[k] = blocks_.kind_count_[k];
+            h.free_count[k] = blocks_.free_blocks_[k].size();
+            free_total += blocks_.free_blocks_[k].size();
+        }
+        h.topk_size = topk_.size();
+        h.refs_size = words_.refs_.size();
+        h.ref_chunks = words_.refs_.chunk_count();
+        h.chars_size = words_.chars_.size();
+        h.char_chunks = words_.chars_.chunk_count();
+
+        auto align = [](uint64_t at) { return (at + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN; };
+        h.nodes_at = align(sizeof(h));
+        h.slots_at = align(h.nodes_at + h.node_chunks * nodes_.CHUNK_SIZE * sizeof(Node));
+        h.free_at = align(h.slots_at + h.slot_chunks * Slots::CHUNK_SIZE * sizeof(uint32_t));
+        h.topk_at = align(h.free_at + free_total * sizeof(uint32_t));
+        h.refs_at = align(h.topk_at + h.topk_size * sizeof(Id));
+        h.chars_at = align(h.refs_at + h.ref_chunks * Refs::CHUNK_SIZE * sizeof(WordPool::Ref));
+        h.file_bytes = h.chars_at + h.char_chunks * Chars::CHUNK_SIZE;
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        auto put = [&](const void* p, size_t n) { out.write(static_cast<const char*>(p), n); };
+        auto pad_to = [&](uint64_t at) {
+            static const char zeros[SNAPSHOT_ALIGN] = {};
+            put(zeros, at - static_cast<uint64_t>(out.tellp()));
+        };
+
+        put(&h, sizeof(h));
+        pad_to(h.nodes_at);
+        for (size_t c = 0; c < h.node_chunks; ++c) put(nodes_.chunk(c), nodes_.CHUNK_SIZE * sizeof(Node));
+        pad_to(h.slots_at);
+        for (size_t c = 0; c < h.slot_chunks; ++c)
+            put(blocks_.slots_.chunk(c), Slots::CHUNK_SIZE * sizeof(uint32_t));
+        pad_to(h.free_at);
+        for (const auto& fl : blocks_.free_blocks_) put(fl.data(), fl.size() * sizeof(uint32_t));
+        pad_to(h.topk_at);
+        put(topk_.data(), topk_.size() * sizeof(Id));
+        pad_to(h.refs_at);
+        for (size_t c = 0; c < h.ref_chunks; ++c)
+            put(words_.refs_.chunk(c), Refs::CHUNK_SIZE * sizeof(WordPool::Ref));
+        pad_to(h.chars_at);
+        for (size_t c = 0; c < h.char_chunks; ++c) put(words_.chars_.chunk(c), Chars::CHUNK_SIZE);
+        return static_cast<bool>(out);
+    }
+
+    // Reemplaza el contenido por el snapshot de path
+    // Cada sección tiene que empezar alineada, después de la anterior, y
+    // entrar entera en el archivo; los tamaños no pueden pasar sus chunks ni
+    // la raíz salir de los nodos. Se revisa antes de apuntar nada al mapeo
+    static bool sections_fit(const SnapshotHeader& h, size_t bytes) {
+        typedef decltype(blocks_.slots_) Slots;
+        typedef decltype(words_.refs_) Refs;
+        typedef decltype(words_.chars_) Chars;
+        uint64_t end = sizeof(SnapshotHeader);
+        auto fits = [&](uint64_t at, uint64_t count, uint64_t elem) {
+            if (at % SNAPSHOT_ALIGN != 0 || at < end || at > bytes) return false;
+            if (count > (bytes - at) / elem) return false;
+            end = at + count * elem;
+            return true;
+        };
+        uint64_t free_total = 0;
+        for (int k = 0; k < NUM_KINDS; ++k) {
+            if (h.free_count[k] > bytes) return false;
+            free_total += h.free_count[k];
+        }
+        return fits(h.nodes_at, h.node_chunks, ChunkArena<Node>::CHUNK_SIZE * sizeof(Node)) &&
+               fits(h.slots_at, h.slot_chunks, Slots::CHUNK_SIZE * sizeof(uint32_t)) &&
+               fits(h.free_at, free_total, sizeof(uint32_t)) &&
+               fits(h.topk_at, h.topk_size, sizeof(Id)) &&
+               fits(h.refs_at, h.ref_chunks, Refs::CHUNK_SIZE * sizeof(WordPool::Ref)) &&
+               fits(h.chars_at, h.char_chunks, Chars::CHUNK_SIZE) &&
+               h.nodes_size <= h.node_chunks * ChunkArena<Node>::CHUNK_SIZE &&
+               h.slots_size <= h.slot_chunks * Slots::CHUNK_SIZE &&
+               h.refs_size <= h.ref_chunks * Refs::CHUNK_SIZE &&
+               h.chars_size <= h.char_chunks * Chars::CHUNK_SIZE && h.root < h.nodes_size;
+    }
+
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size_t bytes = static_cast<size_t>(st.st_size);
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        std::unique_ptr<char, Unmap> mapping(static_cast<char*>(p), Unmap{bytes});
+        const char* base = mapping.get();
+
+        SnapshotHeader h;
+        std::memcpy(&h, base, sizeof(h));
+        if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0 ||
+            h.version != SNAPSHOT_VERSION || h.node_bytes != sizeof(Node) || h.file_bytes != bytes ||
+            h.alphabet_size != static_cast<uint32_t>(ALPHABET_SIZE)) {
+            std::cerr << "Error: " << path << " no es un snapshot compatible" << std::endl;
+            return false;
+        }
+        if (!sections_fit(h, bytes)) {
+            std::cerr << "Error: " << path << " tiene secciones fuera del archivo (snapshot dañado)" << std::endl;
+            return false;
+        }
+
+        // El ranking lo fija el tipo: un snapshot guardado en un modo se
+        // puede abrir en otro (las prioridades se interpretan como tales)
+        clear_storage();
+        topk_cap_ = h.topk_cap;
+        access_counter_ = h.access_counter;
+        node_count_ = h.node_count;
+        total_chars_ = h.total_chars;
+
+        nodes_.attach(reinterpret_cast<Node*>(mapping.get() + h.nodes_at), h.node_chunks,
+                      static_cast<uint32_t>(h.nodes_size));
+        blocks_.slots_.attach(reinterpret_cast<uint32_t*>(mapping.get() + h.slots_at), h.slot_chunks,
+                              static_cast<uint32_t>(h.slots_size));
+        const uint32_t* fl = reinterpret_cast<const uint32_t*>(base + h.free_at);
+        for (int k = 0; k < NUM_KINDS; ++k) {
+            blocks_.free_blocks_[k].assign(fl, fl + h.free_count[k]);
+            fl += h.free_count[k];
+            blocks_.kind_count_[k] = h.kind_count[k];
+        }
+        blocks_.bytes_ = h.block_bytes;
+        const Id* topk = reinterpret_cast<const Id*>(base + h.topk_at);
+        {
+            MemTagScope scope(MemTag::TOPK);
+            topk_.assign(topk, topk + h.topk_size);
+        }
+
+        words_.refs_.attach(reinterpret_cast<WordPool::Ref*>(mapping.get() + h.refs_at), h.ref_chunks,
+                            static_cast<uint32_t>(h.refs_size));
+        words_.chars_.attach(mapping.get() + h.chars_at, h.char_chunks, static_cast<uint32_t>(h.chars_size));
+        words_.bytes_ = h.word_bytes;
+        mapping_ = std::move(mapping);
+        root_ = &nodes_[h.root];
+        return true;
+    }
+
+    // true si path empieza con la firma de un snapshot
+    static bool is_snapshot(const std::string& path) {
+        char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+        std::ifstream in(path, std::ios::binary);
+        in.read(magic, sizeof(magic));
+        return in && std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
     }
 
     // --------------------------------------------------------
@@ -203,45 +1252,148 @@ struct Trie {
     size_t total_chars() const { return total_chars_; } 
 
     size_t approx_memory_bytes() const {
-        return node_count_ * sizeof(Node) + dict_bytes_;
+        return node_count_ * sizeof(Node) + blocks_.bytes_ + words_.memory_bytes() + topk_bytes() + lru_bytes() +
+               window_bytes();
+    }
+
+    // Memoria que ocuparía el mismo árbol con el nodo original de punteros:
+    // parent + next[27] + str + best_terminal + priority + best_priority
+    size_t fixed_layout_memory_bytes() const {
+        size_t fixed_node = 30 * sizeof(void*) + 2 * sizeof(int64_t);
+        return node_count_ * fixed_node + words_.chars_bytes();
     }
 
+    // Bytes reservados por las arenas (incluye la cola libre del último chunk)
+    size_t arena_bytes() const {
+        return nodes_.capacity_bytes() + blocks_.capacity_bytes() + words_.capacity_bytes();
+    }
+
+    size_t topk_bytes() const { return topk_.size() * sizeof(Id); }
+
+    const std::array<size_t, NUM_KINDS>& kind_histogram() const { return blocks_.kind_count_; }
+    size_t word_count() const { return words_.size(); }
+    size_t word_bytes() const { return words_.memory_bytes(); }
+
     // --------------------------------------------------------
     // info en pantalla
     // --------------------------------------------------------
     void print_stats() const {
         std::cout << "=== Estadísticas del Trie ===" << std::endl;
         std::cout << "Nodos totales: " << node_count_ << std::endl;
-        std::cout << "Palabras almacenadas: " << dict_.size() << std::endl;
+        std::cout << "Palabras almacenadas: " << live_words() << std::endl;
         std::cout << "Caracteres totales insertados: " << total_chars_ << std::endl;
         std::cout << "Memoria aproximada: " << approx_memory_bytes() << " bytes" << std::endl;
         std::cout << "Memoria aproximada: " << approx_memory_bytes() / 1024.0 / 1024.0 << " MB" << std::endl;
-        std::cout << "Modo: " << (variant == Variant::MOST_RECENT ? "MÁS RECIENTE" : "MÁS FRECUENTE") << std::endl;
-        if (variant == Variant::MOST_RECENT) {
+        std::cout << "Modo: " << Ranking::NAME << std::endl;
+        if constexpr (variant == Variant::MOST_RECENT) {
             std::cout << "Contador de accesos: " << access_counter_ << std::endl;
         }
+        if (budgeted()) {
+            std::cout << "Presupuesto: " << budget_bytes_ << " bytes / " << budget_words_
+                      << " palabras (0: sin límite), " << evictions_ << " desalojadas" << std::endl;
+        }
+        if (window_cap_) {
+            std::cout << "Ventana deslizante: " << window_cap_ << " palabras" << std::endl;
+        }
+        if (topk_cap_) {
+            std::cout << "Candidatos top-k por nodo: " << topk_cap_ 
+                      << " (" << topk_bytes() / 1024 << " KB)" << std::endl;
+        }
         std::cout << "==============================" << std::endl;
     }
 
 private:
+
+    // Suelta arenas, palabras y el snapshot mapeado (si hay), sin crear la raíz
+    void clear_storage() {
+        nodes_.clear();
+        blocks_.clear();
+        words_.clear();
+        access_counter_ = 0;
+        node_count_ = 0;
+        total_chars_ = 0;
+        topk_.clear();
+        mapping_.reset();
+        lru_clear();
+        budget_bytes_ = budget_words_ = 0;
+        free_nodes_.clear();
+        evictions_ = 0;
+        window_.clear();
+        window_cap_ = window_next_ = 0;
+    }
+
+    // El mejor se publica con release: el lector que lo ve ve también la
+    // palabra y prioridad del terminal
+    void set_best(Node* u, const Node* terminal) {
+        store_shared(u->best, make_best(terminal->priority, terminal->id), std::memory_order_release);
+    }
+
+    // Intenta dejar (p, t) como mejor de u; false si no correspondía
+    bool offer_best(Node* u, int64_t p, Id t) {
+        std::atomic_ref<uint64_t> best(u->best);
+        uint64_t old = best.load(std::memory_order_acquire);
+        while (true) {
+            Id b = static_cast<Id>(old);
+            int64_t bp = static_cast<int64_t>(old >> 32);
+            bool needs_update = b == NONE || p > bp ||
+                (Ranking::NEWER_WINS_TIES && p == bp && b != t);
+            if (!needs_update) return false;
+            if (best.compare_exchange_weak(old, make_best(p, t), std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+                return true;
+            }
+        }
+    }
+
+    // Mantiene las listas top-k del camino tras subir la prioridad de t.
+    // Como las prioridades solo crecen, si t no entra en la lista de un nodo
+    // tampoco entra en la de sus ancestros (su k-ésimo es al menos igual),
+    // así que se corta ahí sin recorrer subárboles. En empate gana el que ya
+    // estaba, igual que best_terminal.
+    void update_topk(Node* t) {
+        if (!topk_cap_) return;
+        for (Node* cur = t; cur; cur = node(cur->parent)) {
+            Id* list = &topk_[cur->id * topk_cap_];
+            int n = cur->topk_count;
+            int pos = static_cast<int>(std::find(list, list + n, t->id) - list);
+            if (pos == n) {
+                if (n < static_cast<int>(topk_cap_)) {
+                    ++cur->topk_count;
+                } else if (t->priority > nodes_[list[n - 1]].priority) {
+                    pos = n - 1;
+                } else {
+                    break;
+                }
+                list[pos] = t->id;
+            }
+            while (pos > 0 && t->priority > nodes_[list[pos - 1]].priority) {
+                std::swap(list[pos], list[pos - 1]);
+                --pos;
+            }
+        }
+    }
     
     void propagate_if_better(Node* terminal) {
         
         // terminal
-        terminal->best_priority = terminal->priority;
-        terminal->best_terminal = terminal;
+        set_best(terminal, terminal);
 
         
-        Node* cur = terminal->parent;
+        Node* cur = node(terminal->parent);
         while (cur) {
-            if (cur->best_terminal == nullptr || 
-                terminal->priority > cur->best_priority) {
-                cur->best_priority = terminal->priority;
-                cur->best_terminal = terminal;
-                cur = cur->parent;
+            if (cur->best_terminal() == NONE || 
+                terminal->priority > cur->best_priority()) {
+                set_best(cur, terminal);
+                cur = node(cur->parent);
             } else {
                 break;
             }
         }
     }
-};
\ No newline at end of file
+};
+
+template <class Ranking> using Trie = BasicTrie<AsciiAlphabet, Ranking>;
+template <class Ranking> using SpanishTrie = BasicTrie<SpanishAlphabet, Ranking>;
+
+// El snapshot guarda los nodos byte a byte
+static_assert(std::is_trivially_copyable<TrieTypes::Node>::value, "TrieTypes::Node debe poder copiarse con memcpy");